@@ -0,0 +1,227 @@
+#ifndef JSON_JSONCOLUMNAR_HPP_
+#define JSON_JSONCOLUMNAR_HPP_
+
+#include "JsonObjectConverter.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace joc
+{
+/**
+ * Columnar (struct of arrays) conversions of collections of JsonObjects.
+ *
+ * A collection of N objects of the same type is represented by one JSON object
+ * with one array of N values per field, e.g. for a std::vector<Contact>:
+ *
+ *   {"name": ["Mary", "Peter"], "age": [52, 34], "e-mail": [null, "peter@hisspace.com"]}
+ *
+ * The columns are driven by the fields of the element type, each key is written
+ * once and empty optionals are represented by null. Compared to an array of
+ * objects, no JSON object is built per element.
+ *
+ * Container is a sequence container (std::vector, std::list, std::deque) of a
+ * JsonObject type. The JSON type is the one of the element type (Row::JsonType).
+ */
+
+/**
+ * @brief Access of the columnar conversions to the row members of JsonObject.
+ */
+struct ColumnarAccess
+{
+    template<typename Row, typename Column>
+    static void appendToColumns(const Row& row, std::vector<Column>& columns)
+    {
+        static_cast<const BasicJsonObject<typename Row::JsonType>&>(row).appendToColumns(columns);
+    }
+
+    template<typename Row, typename Column>
+    static void appendToColumns(const Row& row, std::vector<Column>& columns, const FieldProjection& projection)
+    {
+        static_cast<const BasicJsonObject<typename Row::JsonType>&>(row).appendToColumns(columns, projection);
+    }
+
+    template<typename Row, typename Column>
+    static bool refreshFromColumns(Row& row, const std::vector<const Column*>& columns, std::size_t r)
+    {
+        return static_cast<BasicJsonObject<typename Row::JsonType>&>(row).refreshFromColumns(columns, r);
+    }
+};
+
+template<typename Row>
+std::vector<std::string> columnNames(const Row& row)
+{
+    std::vector<std::string> names;
+    row.visitFields([&names](const typename Row::Pair& pair) { names.push_back(pair.getName()); });
+    return names;
+}
+
+/**
+ * @brief Names of the fields of the row selected by the projection, in the order of the projection.
+ */
+template<typename Row>
+std::vector<std::string> columnNames(const Row& row, const FieldProjection& projection)
+{
+    std::vector<std::string> names;
+    for (const auto& field : projection.fields())
+    {
+        if (row.fieldIndex(field.key))
+        {
+            names.push_back(field.key);
+        }
+    }
+    return names;
+}
+
+template<typename Container>
+typename Container::value_type::JsonType toColumnarJson(const Container& rows)
+{
+    using Row  = typename Container::value_type;
+    using Json = typename Row::JsonType;
+
+    const auto names = rows.empty() ? columnNames(Row()) : columnNames(*rows.begin());
+
+    std::vector<typename Json::array_t> columns(names.size());
+    for (auto& column : columns)
+    {
+        column.reserve(rows.size());
+    }
+    for (const auto& row : rows)
+    {
+        ColumnarAccess::appendToColumns(row, columns);
+    }
+
+    auto columnar = Json::object();
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        columnar[names[i]] = std::move(columns[i]);
+    }
+    return columnar;
+}
+
+/**
+ * @brief Columnar JSON of the fields selected by the projection only, see
+ *        JsonObject::toJson(const FieldProjection&). Selected keys that are not
+ *        fields of the element type are ignored.
+ */
+template<typename Container>
+typename Container::value_type::JsonType toColumnarJson(const Container& rows, const FieldProjection& projection)
+{
+    using Row  = typename Container::value_type;
+    using Json = typename Row::JsonType;
+
+    const auto names = rows.empty() ? columnNames(Row(), projection) : columnNames(*rows.begin(), projection);
+
+    std::vector<typename Json::array_t> columns(names.size());
+    for (auto& column : columns)
+    {
+        column.reserve(rows.size());
+    }
+    for (const auto& row : rows)
+    {
+        ColumnarAccess::appendToColumns(row, columns, projection);
+    }
+
+    auto columnar = Json::object();
+    for (std::size_t i = 0; i < names.size(); ++i)
+    {
+        columnar[names[i]] = std::move(columns[i]);
+    }
+    return columnar;
+}
+
+/**
+ * @brief Resizes the container to the length of the columns and converts each row,
+ *        reusing the objects already in the container.
+ *
+ * @return false if no column is a field of the element type, if the column of a
+ *         mandatory field is missing, or if the columns are not arrays of the same
+ *         length: these are checked first and the container is left unchanged.
+ *         Otherwise false if any row failed as in JsonObject::refreshFromJson,
+ *         e.g. a value of the wrong type, after all rows were converted.
+ */
+template<typename Container>
+bool refreshFromColumnarJson(const typename Container::value_type::JsonType& columnar, Container& rows)
+{
+    using Row  = typename Container::value_type;
+    using Json = typename Row::JsonType;
+
+    if (!columnar.is_object())
+    {
+        return false;
+    }
+
+    std::vector<const typename Json::array_t*> columns;
+    std::size_t rowCount = 0;
+    bool hasColumn       = false;
+    bool valid           = true;
+    Row().visitFields([&](const typename Row::Pair& pair) {
+        const auto it = columnar.find(pair.getName());
+        if (it == columnar.end())
+        {
+            columns.push_back(nullptr);
+            valid = valid && pair.isOptional();
+            return;
+        }
+        if (!it->is_array() || (hasColumn && it->size() != rowCount))
+        {
+            valid = false;
+        }
+        columns.push_back(it->template get_ptr<const typename Json::array_t*>());
+        rowCount  = it->size();
+        hasColumn = true;
+    });
+    if (!valid || !hasColumn)
+    {
+        return false;
+    }
+
+    rows.resize(rowCount);
+    auto success   = true;
+    std::size_t r = 0;
+    for (auto& row : rows)
+    {
+        if (!ColumnarAccess::refreshFromColumns(row, columns, r++))
+        {
+            success = false;
+        }
+    }
+    return success;
+}
+
+/**
+ * @brief Compact binary form of the columnar JSON, in MessagePack.
+ *        Each column is written contiguously.
+ */
+template<typename Container>
+std::vector<std::uint8_t> toColumnarMsgPack(const Container& rows)
+{
+    return Container::value_type::JsonType::to_msgpack(toColumnarJson(rows));
+}
+
+template<typename Container>
+std::vector<std::uint8_t> toColumnarMsgPack(const Container& rows, const FieldProjection& projection)
+{
+    return Container::value_type::JsonType::to_msgpack(toColumnarJson(rows, projection));
+}
+
+/**
+ * @return false if the data is not valid MessagePack, otherwise as refreshFromColumnarJson
+ */
+template<typename Container>
+bool refreshFromColumnarMsgPack(const std::vector<std::uint8_t>& msgPack, Container& rows)
+{
+    const auto columnar = Container::value_type::JsonType::from_msgpack(msgPack, true, false);
+    if (columnar.is_discarded())
+    {
+        return false;
+    }
+    return refreshFromColumnarJson(columnar, rows);
+}
+
+} // namespace joc
+
+#endif
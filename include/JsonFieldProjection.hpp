@@ -0,0 +1,124 @@
+#ifndef JSON_JSONFIELDPROJECTION_HPP_
+#define JSON_JSONFIELDPROJECTION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace joc
+{
+/**
+ * @brief Selection of the fields to convert with JsonObject::toJson(const FieldProjection&),
+ *        e.g. from the "fields" parameter of a request:
+ *
+ *          const auto projection = FieldProjection::parse("owner,contact_list/name");
+ *          book.toJson(projection);   // {"contact_list":[{"name":"Mary"},...],"owner":"Ricardo"}
+ *
+ *        A path selects a field by key, and further keys separated by '/' select
+ *        fields of the JsonObjects in that field (a JsonObject, an optional one, or a
+ *        container of them). A field selected without a sub-path is converted whole.
+ *        The fields that are not selected are not converted at all.
+ *
+ *        Parse the projection once and reuse it: the positions of the selected
+ *        fields are resolved on the first conversion of each JsonObject class and
+ *        kept in the projection, so further conversions do not look up the keys.
+ */
+class FieldProjection
+{
+public:
+    struct Field;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Position of a key in the fields of the class identified by schema,
+     *        npos if it is not a field.
+     */
+    using Resolver = std::size_t (*)(const void* schema, std::string_view key);
+
+    FieldProjection() = default;
+    FieldProjection(std::initializer_list<std::string_view> paths);
+
+    /**
+     * @param fields comma separated paths, spaces around the paths are ignored
+     */
+    static FieldProjection parse(std::string_view fields);
+
+    /**
+     * @brief Adds a path, e.g. "contact_list/name". Adding a path and one of its
+     *        sub-paths selects the whole field.
+     */
+    void add(std::string_view path);
+
+    /**
+     * @return the selected fields, in the order they were first added
+     */
+    const std::vector<Field>& fields() const;
+
+    /**
+     * @return nullptr if the key is not selected
+     */
+    const Field* find(std::string_view key) const;
+
+    bool empty() const;
+
+    /**
+     * @brief Positions of the selected fields in the objects of a class, in the order
+     *        of fields(). Resolved with resolve on the first call for that class, and
+     *        kept in the projection for the next calls. Safe to call concurrently, as
+     *        long as the projection is not modified meanwhile.
+     *
+     * @param schema identity of the class, the same for all its objects
+     */
+    const std::vector<std::size_t>& positions(const void* schema, Resolver resolve) const;
+
+private:
+    /**
+     * Positions resolved per class. Copies of a projection start without them.
+     */
+    struct PositionCache
+    {
+        struct Entry
+        {
+            const void* schema;
+            std::vector<std::size_t> positions;
+        };
+
+        PositionCache() = default;
+        PositionCache(const PositionCache&)
+        {
+        }
+        PositionCache& operator=(const PositionCache&)
+        {
+            clear();
+            return *this;
+        }
+
+        void clear();
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<const Entry>> entries;
+        // The last resolved class, read without locking
+        std::atomic<const Entry*> last{nullptr};
+    };
+
+    std::vector<Field> mFields;
+    mutable PositionCache mPositions;
+};
+
+struct FieldProjection::Field
+{
+    std::string key;
+    bool whole{true};
+    // Selected fields of the nested JsonObjects, if not whole
+    FieldProjection nested;
+};
+
+} // namespace joc
+
+#endif
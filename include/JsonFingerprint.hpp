@@ -0,0 +1,473 @@
+#ifndef JSON_JSONFINGERPRINT_HPP_
+#define JSON_JSONFINGERPRINT_HPP_
+
+#include "JsonTimestampCodec.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace joc
+{
+
+template<typename Json>
+class BasicJsonObject;
+
+template<typename T, typename Json>
+class Lazy;
+
+/**
+ * @brief Fast non-cryptographic 64-bit hash used by JsonObject::fingerprint().
+ *        The digest only depends on the sequence of values fed to it: bytes are
+ *        read in little-endian order and no per-process seed is used, so it is
+ *        stable across processes, builds and platforms.
+ */
+class FingerprintHasher
+{
+public:
+    void update(std::uint64_t value)
+    {
+        mState = mix(mState ^ mix(value + GOLDEN_RATIO));
+    }
+
+    void update(std::string_view bytes)
+    {
+        const auto* data = reinterpret_cast<const unsigned char*>(bytes.data());
+        std::size_t size = bytes.size();
+        for (; size >= 8; data += 8, size -= 8)
+        {
+            update(load(data, 8));
+        }
+        update(load(data, size) ^ (static_cast<std::uint64_t>(bytes.size()) << 56));
+    }
+
+    std::uint64_t digest() const
+    {
+        return mix(mState);
+    }
+
+private:
+    static constexpr std::uint64_t GOLDEN_RATIO = 0x9E3779B97F4A7C15ULL;
+
+    // Finalizer of splitmix64
+    static std::uint64_t mix(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static std::uint64_t load(const unsigned char* data, std::size_t size)
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            value |= static_cast<std::uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    std::uint64_t mState{0};
+};
+
+template<typename T>
+struct IsOptional : std::false_type
+{
+};
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsPair : std::false_type
+{
+};
+template<typename First, typename Second>
+struct IsPair<std::pair<First, Second>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsDuration : std::false_type
+{
+};
+template<typename Rep, typename Per>
+struct IsDuration<std::chrono::duration<Rep, Per>> : std::true_type
+{
+};
+
+template<typename T>
+struct IsLazy : std::false_type
+{
+};
+template<typename T, typename Json>
+struct IsLazy<Lazy<T, Json>> : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct IsIterable : std::false_type
+{
+};
+template<typename T>
+struct IsIterable<T, std::void_t<decltype(std::begin(std::declval<const T&>()), std::end(std::declval<const T&>()))>>
+    : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct HasEqualityOperator : std::false_type
+{
+};
+template<typename T>
+struct HasEqualityOperator<T, std::void_t<decltype(std::declval<const T&>() == std::declval<const T&>())>>
+    : std::true_type
+{
+};
+
+/**
+ * std::unordered_map, std::unordered_set and their multi versions: equal containers
+ * may iterate their elements in different orders.
+ */
+template<typename T, typename = void>
+struct IsUnorderedContainer : std::false_type
+{
+};
+template<typename T>
+struct IsUnorderedContainer<T, std::void_t<typename T::hasher, typename T::key_equal, typename T::key_type>>
+    : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct IsMap : std::false_type
+{
+};
+template<typename T>
+struct IsMap<T, std::void_t<typename T::mapped_type>> : std::true_type
+{
+};
+
+template<typename T>
+constexpr bool IsStringLike =
+    std::is_convertible_v<const T&, std::string_view> && !nlohmann::detail::is_basic_json<T>::value;
+
+template<typename Json, typename T>
+void hashValue(FingerprintHasher& hasher, const T& value);
+
+inline void hashNumber(FingerprintHasher& hasher, double value)
+{
+    // +0.0 and -0.0 are equal
+    const double d = (value == 0) ? 0.0 : value;
+    std::uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(bits));
+    hasher.update(bits);
+}
+
+/**
+ * @brief Hash of a sequence of elements that does not depend on their order:
+ *        the digests of the elements are added.
+ */
+template<typename Range, typename HashElement>
+void hashUnordered(FingerprintHasher& hasher, const Range& range, HashElement&& hashElement)
+{
+    std::uint64_t sum  = 0;
+    std::uint64_t size = 0;
+    for (const auto& element : range)
+    {
+        FingerprintHasher elementHasher;
+        hashElement(elementHasher, element);
+        sum += elementHasher.digest();
+        ++size;
+    }
+    hasher.update(sum);
+    hasher.update(size);
+}
+
+/**
+ * @brief Structural hash of a JSON value, consistent with its operator==: numbers
+ *        are hashed as doubles, so that 1 and 1.0 are hashed equally, and object
+ *        members independently of their order. (Unsigned numbers above the int64
+ *        range equal to negative integers by nlohmann::json are the exception.)
+ */
+template<typename BasicJsonType>
+void hashJson(FingerprintHasher& hasher, const BasicJsonType& value)
+{
+    using Type = nlohmann::detail::value_t;
+
+    // Numbers share one tag, as they compare equal across their types
+    const auto type = value.type();
+    const bool number =
+        type == Type::number_integer || type == Type::number_unsigned || type == Type::number_float;
+    hasher.update(number ? static_cast<std::uint64_t>(Type::number_float) : static_cast<std::uint64_t>(type));
+
+    switch (type)
+    {
+    case Type::boolean:
+        hasher.update(value.template get<bool>() ? 1 : 0);
+        break;
+    case Type::number_integer:
+        hashNumber(hasher, static_cast<double>(*value.template get_ptr<const typename BasicJsonType::number_integer_t*>()));
+        break;
+    case Type::number_unsigned:
+        hashNumber(hasher, static_cast<double>(*value.template get_ptr<const typename BasicJsonType::number_unsigned_t*>()));
+        break;
+    case Type::number_float:
+        hashNumber(hasher, static_cast<double>(*value.template get_ptr<const typename BasicJsonType::number_float_t*>()));
+        break;
+    case Type::string:
+    {
+        const auto& text = *value.template get_ptr<const typename BasicJsonType::string_t*>();
+        hasher.update(std::string_view(text.data(), text.size()));
+        break;
+    }
+    case Type::binary:
+    {
+        const auto& binary = *value.template get_ptr<const typename BasicJsonType::binary_t*>();
+        hasher.update(std::string_view(reinterpret_cast<const char*>(binary.data()), binary.size()));
+        hasher.update(binary.has_subtype() ? binary.subtype() + 1 : 0);
+        break;
+    }
+    case Type::array:
+        for (const auto& element : value)
+        {
+            hashJson(hasher, element);
+        }
+        hasher.update(value.size());
+        break;
+    case Type::object:
+    {
+        const auto& object = *value.template get_ptr<const typename BasicJsonType::object_t*>();
+        hashUnordered(hasher, object, [](FingerprintHasher& memberHasher, const auto& member) {
+            memberHasher.update(std::string_view(member.first.data(), member.first.size()));
+            hashJson(memberHasher, member.second);
+        });
+        break;
+    }
+    default:
+        // null and discarded
+        break;
+    }
+}
+
+/**
+ * @brief Feeds a value to the hasher. Equal values (as in valuesEqual) are hashed equally.
+ *        Nested JsonObjects contribute their fingerprint, containers their elements
+ *        and size (in any order for unordered containers), and types without
+ *        a dedicated rule their JSON conversion.
+ */
+template<typename Json, typename T>
+void hashValue(FingerprintHasher& hasher, const T& value)
+{
+    if constexpr (nlohmann::detail::is_basic_json<T>::value)
+    {
+        hashJson(hasher, value);
+    }
+    else if constexpr (std::is_same_v<T, bool>)
+    {
+        hasher.update(value ? 1 : 0);
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        hasher.update(static_cast<std::uint64_t>(value));
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        hashNumber(hasher, static_cast<double>(value));
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        hashValue<Json>(hasher, static_cast<std::underlying_type_t<T>>(value));
+    }
+    else if constexpr (IsStringLike<T>)
+    {
+        hasher.update(std::string_view(value));
+    }
+    else if constexpr (std::is_base_of_v<BasicJsonObject<Json>, T>)
+    {
+        hasher.update(value.fingerprint());
+    }
+    else if constexpr (IsOptional<T>::value)
+    {
+        hasher.update(value.has_value() ? 1 : 0);
+        if (value.has_value())
+        {
+            hashValue<Json>(hasher, *value);
+        }
+    }
+    else if constexpr (IsDuration<T>::value)
+    {
+        hashValue<Json>(hasher, value.count());
+    }
+    else if constexpr (IsTimePoint<T>::value)
+    {
+        hashValue<Json>(hasher, value.time_since_epoch());
+    }
+    else if constexpr (IsPair<T>::value)
+    {
+        hashValue<Json>(hasher, value.first);
+        hashValue<Json>(hasher, value.second);
+    }
+    else if constexpr (IsLazy<T>::value)
+    {
+        // Converts the raw JSON, two raw forms of the same value may differ
+        hashValue<Json>(hasher, value.get());
+    }
+    else if constexpr (IsUnorderedContainer<T>::value)
+    {
+        hashUnordered(hasher, value, [](FingerprintHasher& elementHasher, const auto& element) {
+            hashValue<Json>(elementHasher, element);
+        });
+    }
+    else if constexpr (IsIterable<T>::value)
+    {
+        std::uint64_t size = 0;
+        for (const auto& element : value)
+        {
+            hashValue<Json>(hasher, element);
+            ++size;
+        }
+        hasher.update(size);
+    }
+    else
+    {
+        hashJson(hasher, Json(value));
+    }
+}
+
+template<typename Json, typename T>
+bool valuesEqual(const T& lhs, const T& rhs);
+
+/**
+ * @brief Compares unordered containers regardless of the iteration order, as their
+ *        operator== does: each group of equivalent keys must hold the same values,
+ *        compared with valuesEqual so that values without operator== are supported.
+ */
+template<typename Json, typename T>
+bool unorderedEqual(const T& lhs, const T& rhs)
+{
+    if constexpr (!IsMap<T>::value)
+    {
+        // Set elements are compared by key_equal
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+        for (const auto& element : lhs)
+        {
+            if (lhs.count(element) != rhs.count(element))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    else
+    {
+        if (lhs.size() != rhs.size())
+        {
+            return false;
+        }
+        for (const auto& element : lhs)
+        {
+            const auto countEqual = [&element](const T& container) {
+                const auto range = container.equal_range(element.first);
+                std::size_t count = 0;
+                for (auto it = range.first; it != range.second; ++it)
+                {
+                    count += valuesEqual<Json>(it->second, element.second) ? 1 : 0;
+                }
+                return count;
+            };
+            if (countEqual(lhs) != countEqual(rhs))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Compares two values, recursing into optionals, pairs and containers
+ *        so that elements without operator== (compared through their JSON
+ *        conversion) are supported.
+ */
+template<typename Json, typename T>
+bool valuesEqual(const T& lhs, const T& rhs)
+{
+    if constexpr (nlohmann::detail::is_basic_json<T>::value || std::is_arithmetic_v<T> || std::is_enum_v<T> || IsStringLike<T>)
+    {
+        return lhs == rhs;
+    }
+    else if constexpr (std::is_base_of_v<BasicJsonObject<Json>, T>)
+    {
+        // JsonObject::operator==, unless the derived class defines its own
+        return lhs == rhs;
+    }
+    else if constexpr (IsOptional<T>::value)
+    {
+        if (lhs.has_value() != rhs.has_value())
+        {
+            return false;
+        }
+        return !lhs.has_value() || valuesEqual<Json>(*lhs, *rhs);
+    }
+    else if constexpr (IsPair<T>::value)
+    {
+        return valuesEqual<Json>(lhs.first, rhs.first) && valuesEqual<Json>(lhs.second, rhs.second);
+    }
+    else if constexpr (IsLazy<T>::value)
+    {
+        return valuesEqual<Json>(lhs.get(), rhs.get());
+    }
+    else if constexpr (IsUnorderedContainer<T>::value)
+    {
+        return unorderedEqual<Json>(lhs, rhs);
+    }
+    else if constexpr (IsIterable<T>::value && !IsDuration<T>::value && !IsTimePoint<T>::value)
+    {
+        auto lhsIt = std::begin(lhs);
+        auto rhsIt = std::begin(rhs);
+        for (; lhsIt != std::end(lhs) && rhsIt != std::end(rhs); ++lhsIt, ++rhsIt)
+        {
+            if (!valuesEqual<Json>(*lhsIt, *rhsIt))
+            {
+                return false;
+            }
+        }
+        return lhsIt == std::end(lhs) && rhsIt == std::end(rhs);
+    }
+    else if constexpr (HasEqualityOperator<T>::value)
+    {
+        return lhs == rhs;
+    }
+    else
+    {
+        return Json(lhs) == Json(rhs);
+    }
+}
+
+template<typename Json, typename T>
+void templateHash(FingerprintHasher& hasher, const void* value)
+{
+    hashValue<Json>(hasher, *static_cast<const T*>(value));
+}
+
+template<typename Json, typename T>
+bool templateEquals(const void* lhs, const void* rhs)
+{
+    return valuesEqual<Json>(*static_cast<const T*>(lhs), *static_cast<const T*>(rhs));
+}
+
+} // namespace joc
+
+#endif
@@ -0,0 +1,350 @@
+#ifndef JSON_JSONLAZY_HPP_
+#define JSON_JSONLAZY_HPP_
+
+#include "JsonPairConverterHelper.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+
+namespace joc
+{
+/**
+ * @brief Document given to JsonObject::refreshFromJson(std::shared_ptr<const Json>),
+ *        while it runs in this thread. The Lazy members converted meanwhile keep
+ *        a reference to their value in it, instead of a copy, as long as the value
+ *        is part of the document (see Value).
+ */
+template<typename Json>
+class LazyDocumentScope
+{
+public:
+    explicit LazyDocumentScope(const std::shared_ptr<const Json>& document)
+        : mPrevious(current)
+        , mDocument(&document)
+        , mValue(document.get())
+    {
+        current = this;
+    }
+    ~LazyDocumentScope()
+    {
+        current = mPrevious;
+    }
+
+    LazyDocumentScope(const LazyDocumentScope&) = delete;
+    LazyDocumentScope& operator=(const LazyDocumentScope&) = delete;
+
+    /**
+     * @return the document of the innermost scope of this thread if value is part
+     *         of it, nullptr otherwise
+     */
+    static const std::shared_ptr<const Json>* documentOf(const Json& value)
+    {
+        return current != nullptr && current->contains(value) ? current->mDocument : nullptr;
+    }
+
+    /**
+     * @brief Marks a value of the document as the one being converted, while it lives.
+     *        Only the value being converted, its members and the elements of its
+     *        arrays are recognized as part of the document: values that were copied
+     *        (e.g. by a custom from_json) are not, so they are never referenced.
+     *        Does nothing if the value is not part of the document.
+     */
+    class Value
+    {
+    public:
+        explicit Value(const Json& value)
+            : mScope(current != nullptr && current->contains(value) ? current : nullptr)
+            , mPrevious(mScope != nullptr ? mScope->mValue : nullptr)
+        {
+            if (mScope != nullptr)
+            {
+                mScope->mValue = &value;
+            }
+        }
+        ~Value()
+        {
+            if (mScope != nullptr)
+            {
+                mScope->mValue = mPrevious;
+            }
+        }
+
+        Value(const Value&) = delete;
+        Value& operator=(const Value&) = delete;
+
+    private:
+        LazyDocumentScope* mScope;
+        const Json* mPrevious;
+    };
+
+private:
+    bool contains(const Json& value) const
+    {
+        if (&value == mValue)
+        {
+            return true;
+        }
+        if (mValue->is_array())
+        {
+            return isElement(*mValue, value);
+        }
+        if (mValue->is_object())
+        {
+            for (const auto& member : *mValue)
+            {
+                if (&member == &value || (member.is_array() && isElement(member, value)))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    static bool isElement(const Json& array, const Json& value)
+    {
+        // The elements of a JSON array are contiguous
+        if (array.empty())
+        {
+            return false;
+        }
+        const std::less<const Json*> less;
+        return !less(&value, &array.front()) && !less(&array.back(), &value);
+    }
+
+    inline static thread_local LazyDocumentScope* current = nullptr;
+
+    LazyDocumentScope* mPrevious;
+    const std::shared_ptr<const Json>* mDocument;
+    const Json* mValue;
+};
+
+/**
+ * @brief JSON type of a Lazy<T>: the one of T if it is a JsonObject, nlohmann::json otherwise.
+ */
+template<typename T, typename = void>
+struct LazyJsonOf
+{
+    using type = nlohmann::json;
+};
+template<typename T>
+struct LazyJsonOf<T, std::void_t<typename T::JsonType>>
+{
+    using type = typename T::JsonType;
+};
+
+/**
+ * @brief Member wrapper that defers the conversion of a value from JSON until
+ *        it is accessed, for large members that are seldom read, e.g.:
+ *
+ *          struct Message : public JsonObject
+ *          {
+ *              Message() : JsonObject({{"id", id}, {"book", book}}) {}
+ *              int id;
+ *              Lazy<ContactBook> book;
+ *          };
+ *
+ *        refreshFromJson only checks the JSON type of the value and keeps it raw:
+ *        a copy of it, or a reference to it when the object is refreshed from a
+ *        shared document (see JsonObject::refreshFromJson(std::shared_ptr<const Json>)).
+ *        get() converts it on first access. toJson writes the raw value back as
+ *        long as it was not modified through getMutable() or an assignment.
+ *
+ *        Conversion errors are reported on access, as refreshFromJson would report
+ *        them for a T member (messages or nlohmann::json exceptions); after an
+ *        exception, the next get() converts again. The first get() converts under
+ *        a lock, so const accesses from several threads are safe. Modifications
+ *        (getMutable(), assignments, refreshFromJson) are not synchronized, like
+ *        for the other members.
+ *
+ *        Json must be the JSON type of the enclosing JsonObject, which is checked
+ *        when binding the member. It defaults to the JSON type of T for JsonObjects,
+ *        so Lazy<T> only needs it for other types in an OrderedJsonObject.
+ */
+template<typename T, typename Json = typename LazyJsonOf<T>::type>
+class Lazy
+{
+public:
+    using JsonType = Json;
+
+    Lazy() = default;
+    Lazy(const T& value)
+        : mValue(value)
+        , mDecoded(true)
+    {
+    }
+
+    // Only the converted value of other is read, never while another thread converts it
+    Lazy(const Lazy& other)
+        : mRaw(other.mRaw)
+    {
+        if (other.isDecoded())
+        {
+            mValue = other.mValue;
+            mDecoded.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    Lazy& operator=(const Lazy& other)
+    {
+        if (this != &other)
+        {
+            mRaw = other.mRaw;
+            if (other.isDecoded())
+            {
+                mValue = other.mValue;
+                mDecoded.store(true, std::memory_order_relaxed);
+            }
+            else
+            {
+                mValue.reset();
+                mDecoded.store(false, std::memory_order_relaxed);
+            }
+        }
+        return *this;
+    }
+
+    Lazy& operator=(const T& value)
+    {
+        mValue = value;
+        mDecoded.store(true, std::memory_order_relaxed);
+        mRaw.reset();
+        return *this;
+    }
+
+    /**
+     * @return the value, converted from the raw JSON on the first call
+     */
+    const T& get() const
+    {
+        if (!mDecoded.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lk(mMutex);
+            if (!mDecoded.load(std::memory_order_relaxed))
+            {
+                decode();
+            }
+        }
+        return mValue.value();
+    }
+
+    /**
+     * @return the value for modification, the raw JSON is discarded
+     */
+    T& getMutable()
+    {
+        get();
+        mRaw.reset();
+        return mValue.value();
+    }
+
+    const T& operator*() const
+    {
+        return get();
+    }
+    const T* operator->() const
+    {
+        return &get();
+    }
+
+    /**
+     * @return true if the value was converted (or assigned)
+     */
+    bool isDecoded() const
+    {
+        return mDecoded.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return the raw JSON that toJson writes back, nullptr if there is none
+     *         or the value was modified
+     */
+    const Json* raw() const
+    {
+        return mRaw.get();
+    }
+
+    /**
+     * @brief Replaces the value by a raw JSON, converted on the next get()
+     */
+    void setRaw(std::shared_ptr<const Json> raw)
+    {
+        mRaw = std::move(raw);
+        mValue.reset();
+        mDecoded.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    void decode() const
+    {
+        mValue.emplace();
+        if (mRaw)
+        {
+            try
+            {
+                templateFromJson<Json, T>(*mRaw, &mValue.value());
+            }
+            catch (...)
+            {
+                mValue.reset();
+                throw;
+            }
+        }
+        mDecoded.store(true, std::memory_order_release);
+    }
+
+    mutable std::optional<T> mValue;
+    std::shared_ptr<const Json> mRaw;
+    mutable std::atomic<bool> mDecoded{false};
+    mutable std::mutex mMutex;
+};
+
+/**
+ * @brief True for a Lazy converted with another JSON type than Json.
+ */
+template<typename T, typename Json>
+struct IsLazyOfOtherJson : std::false_type
+{
+};
+template<typename T, typename LazyJson, typename Json>
+struct IsLazyOfOtherJson<Lazy<T, LazyJson>, Json> : std::negation<std::is_same<LazyJson, Json>>
+{
+};
+
+template<typename Json, typename T>
+void to_json(Json& j, const Lazy<T, Json>& lazy)
+{
+    if (lazy.raw() != nullptr)
+    {
+        j = *lazy.raw();
+    }
+    else
+    {
+        j = templateToJson<Json, T>(&lazy.get());
+    }
+}
+
+template<typename Json, typename T>
+void from_json(const Json& j, Lazy<T, Json>& lazy)
+{
+    const auto* document = LazyDocumentScope<Json>::documentOf(j);
+    if (document != nullptr)
+    {
+        // Shares the ownership of the document, j is part of it
+        lazy.setRaw(std::shared_ptr<const Json>(*document, &j));
+    }
+    else
+    {
+        lazy.setRaw(std::make_shared<const Json>(j));
+    }
+}
+
+} // namespace joc
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef JSON_JSONNUMERICARRAYCODEC_HPP_
+#define JSON_JSONNUMERICARRAYCODEC_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace joc
+{
+
+/**
+ * @brief JSON representation of a contiguous array of numbers (std::vector or
+ *        std::array of an arithmetic type other than bool).
+ *
+ *        - Array:  JSON array of numbers, the default representation.
+ *        - Base64: RFC 4648 base64 string (with padding) of the elements in
+ *                  little-endian byte order. Exact for every value, and much
+ *                  faster to write and to parse than numbers in text.
+ */
+enum class NumericArrayEncoding
+{
+    Array,
+    Base64
+};
+
+template<typename T>
+struct IsNumericArray : std::false_type
+{
+};
+template<typename T, typename Allocator>
+struct IsNumericArray<std::vector<T, Allocator>>
+    : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>
+{
+};
+template<typename T, std::size_t N>
+struct IsNumericArray<std::array<T, N>> : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>
+{
+};
+
+/**
+ * @return length of the base64 text of size bytes
+ */
+inline std::size_t base64EncodedLength(std::size_t size)
+{
+    return (size + 2) / 3 * 4;
+}
+
+/**
+ * @return number of bytes encoded in a base64 text, or SIZE_MAX if its length
+ *         or its padding is invalid (the characters are checked by decodeBase64)
+ */
+std::size_t base64DecodedLength(std::string_view text);
+
+/**
+ * @param out  buffer of base64EncodedLength(size) characters, not null-terminated
+ */
+void encodeBase64(const void* data, std::size_t size, char* out);
+
+/**
+ * @return true if the length, the padding and the characters of the text are valid
+ */
+bool isBase64(std::string_view text);
+
+/**
+ * @param out  buffer of base64DecodedLength(text) bytes
+ * @return false if the text is not valid base64
+ */
+bool decodeBase64(std::string_view text, void* out);
+
+/**
+ * @brief JSON type name produced by a given encoding, as in nlohmann::json::type_name().
+ */
+inline const char* numericArrayJsonTypeName(NumericArrayEncoding encoding)
+{
+    return encoding == NumericArrayEncoding::Base64 ? "string" : "array";
+}
+
+template<typename T>
+struct IsStdArray : std::false_type
+{
+};
+template<typename T, std::size_t N>
+struct IsStdArray<std::array<T, N>> : std::true_type
+{
+};
+
+inline bool isLittleEndian()
+{
+    const std::uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+template<typename T>
+void reverseElementBytes(T* values, std::size_t count)
+{
+    auto* bytes = reinterpret_cast<unsigned char*>(values);
+    for (std::size_t i = 0; i < count; ++i, bytes += sizeof(T))
+    {
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+}
+
+/**
+ * @brief Same conversion as nlohmann::json's get_to for arithmetic types, with
+ *        the type switch inlined for the numbers.
+ */
+template<typename Json, typename T>
+void numberFromJson(const Json& value, T& out)
+{
+    switch (value.type())
+    {
+    case nlohmann::detail::value_t::number_float:
+        out = static_cast<T>(*value.template get_ptr<const typename Json::number_float_t*>());
+        break;
+    case nlohmann::detail::value_t::number_integer:
+        out = static_cast<T>(*value.template get_ptr<const typename Json::number_integer_t*>());
+        break;
+    case nlohmann::detail::value_t::number_unsigned:
+        out = static_cast<T>(*value.template get_ptr<const typename Json::number_unsigned_t*>());
+        break;
+    default:
+        // nlohmann::json converts booleans and reports the other types
+        value.get_to(out);
+        break;
+    }
+}
+
+template<typename Json = nlohmann::json, typename Container>
+Json numericArrayToJson(const Container& values, NumericArrayEncoding encoding)
+{
+    static_assert(IsNumericArray<Container>::value, "Container must be a std::vector or std::array of numbers");
+    using Element = typename Container::value_type;
+
+    if (encoding != NumericArrayEncoding::Base64)
+    {
+        return values;
+    }
+
+    const std::size_t size = values.size() * sizeof(Element);
+    typename Json::string_t text(base64EncodedLength(size), '\0');
+    if (isLittleEndian())
+    {
+        encodeBase64(values.data(), size, &text[0]);
+    }
+    else
+    {
+        std::vector<Element> littleEndian(values.begin(), values.end());
+        reverseElementBytes(littleEndian.data(), littleEndian.size());
+        encodeBase64(littleEndian.data(), size, &text[0]);
+    }
+    return Json(std::move(text));
+}
+
+/**
+ * @brief Checks the values of j before any of them is written, so that
+ *        decodeNumericArray cannot fail halfway. As with nlohmann::json,
+ *        an element which is neither a number nor a boolean throws.
+ *
+ * @return false if the base64 text is invalid
+ */
+template<typename Json, typename Element>
+bool checkNumericArray(const Json& j, NumericArrayEncoding encoding)
+{
+    if (encoding == NumericArrayEncoding::Base64)
+    {
+        const auto& text = j.template get_ref<const typename Json::string_t&>();
+        return isBase64(std::string_view(text.data(), text.size()));
+    }
+
+    for (const auto& item : j)
+    {
+        if (!item.is_number() && !item.is_boolean())
+        {
+            Element element;
+            numberFromJson(item, element);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the count numbers of j, in the given encoding, to out.
+ *        The values of j must have been checked by checkNumericArray.
+ */
+template<typename Json, typename Element>
+void decodeNumericArray(const Json& j, NumericArrayEncoding encoding, Element* out, std::size_t count)
+{
+    if (encoding == NumericArrayEncoding::Base64)
+    {
+        const auto& text = j.template get_ref<const typename Json::string_t&>();
+        decodeBase64(std::string_view(text.data(), text.size()), out);
+        if (!isLittleEndian())
+        {
+            reverseElementBytes(out, count);
+        }
+        return;
+    }
+
+    for (const auto& item : j)
+    {
+        numberFromJson(item, *out++);
+    }
+}
+
+/**
+ * @brief Converts the whole array at once: the values are checked first, then
+ *        decoded in place into the container, resized once, so that an invalid
+ *        value leaves it unchanged and refreshing a std::vector of the same size
+ *        does not allocate. A std::array must have as many elements as the
+ *        JSON value.
+ *
+ * @return false if the JSON value does not match the encoding or the size
+ */
+template<typename Json, typename Container>
+bool numericArrayFromJson(const Json& j, NumericArrayEncoding encoding, Container& values)
+{
+    static_assert(IsNumericArray<Container>::value, "Container must be a std::vector or std::array of numbers");
+    using Element = typename Container::value_type;
+
+    std::size_t count = 0;
+    if (encoding == NumericArrayEncoding::Base64)
+    {
+        if (!j.is_string())
+        {
+            return false;
+        }
+        const auto& text = j.template get_ref<const typename Json::string_t&>();
+        const auto size  = base64DecodedLength(std::string_view(text.data(), text.size()));
+        if (size == std::numeric_limits<std::size_t>::max() || size % sizeof(Element) != 0)
+        {
+            return false;
+        }
+        count = size / sizeof(Element);
+    }
+    else
+    {
+        if (!j.is_array())
+        {
+            return false;
+        }
+        count = j.size();
+    }
+
+    if constexpr (IsStdArray<Container>::value)
+    {
+        if (count != values.size())
+        {
+            return false;
+        }
+    }
+    if (!checkNumericArray<Json, Element>(j, encoding))
+    {
+        return false;
+    }
+    if constexpr (!IsStdArray<Container>::value)
+    {
+        values.resize(count);
+    }
+    decodeNumericArray(j, encoding, values.data(), count);
+    return true;
+}
+
+} // namespace joc
+
+#endif
@@ -1,15 +1,25 @@
 #ifndef JSONOBJECTCONVERTER_HPP_
 #define JSONOBJECTCONVERTER_HPP_
 
+#include "JsonLazy.hpp"
 #include "JsonPairConverter.hpp"
 
 #include "nlohmann/json.hpp"
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace joc
 {
+struct ColumnarAccess;
+
 /**
  * @brief This class can be used as a base class for JSON-based data containers.
  *        It provides the means for:
@@ -30,23 +40,63 @@ namespace joc
  *             NOTE: The derived class is responsible for NOT locking the same mutex
  *             while calling toJson or refreshFromJson from the same thread.
  *
+ *          4. Typed access to the fields by key or by JSON Pointer, without
+ *             converting the object to JSON (see get, set and visitFields).
+ *
+ *          5. Comparison and hashing of the fields, without converting the
+ *             object to JSON (see operator== and fingerprint).
+ *
+ *          6. Optionally, keeping the keys that are not fields, to forward them
+ *             unchanged (see setKeepUnknownKeys).
+ *
+ *          7. Optionally, caching the serialized object for objects that are read
+ *             more often than they change (see setSerializationCache).
+ *
+ *        Json is the nlohmann::basic_json specialization used for the conversions.
+ *        JsonObject uses nlohmann::json, whose objects are std::maps (output sorted
+ *        by key), and OrderedJsonObject uses nlohmann::ordered_json, whose objects
+ *        are vector-backed maps (output in declaration order). The member functions
+ *        are compiled in joclib for these two, other specializations must include
+ *        JsonObjectConverterImpl.hpp.
+ *
  *        Example: see joc_sample.cpp
  */
-class JsonObject
+template<typename Json>
+class BasicJsonObject
 {
 public:
-    JsonObject(const std::vector<JsonPair>& pairs = {}, std::mutex* dataMutex = nullptr);
-    virtual ~JsonObject() = default;
+    using JsonType = Json;
+    using Pair     = BasicJsonPair<Json>;
+    // Lets derived classes name their base JsonObject, whatever the Json type
+    using JsonObject = BasicJsonObject;
+
+    /**
+     * @brief Hits and misses of the serialization cache (see setSerializationCache).
+     */
+    struct SerializationCacheStats
+    {
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+    };
+
+    BasicJsonObject(const std::vector<Pair>& pairs = {}, std::mutex* dataMutex = nullptr);
+    virtual ~BasicJsonObject() = default;
 
     /**
      * See Cellcyte class examples that use JsonObject as
      * a reference.
      */
-    JsonObject(const JsonObject&);
-    JsonObject& operator=(const JsonObject&);
+    BasicJsonObject(const BasicJsonObject&);
+    /**
+     * @brief Assigns the unknown keys and their setting, and increments the generation.
+     *        The fields are members of the child class, assigned by it after this
+     *        returns: when the object may be serialized by another thread meanwhile,
+     *        call invalidate() once the whole assignment is done.
+     */
+    BasicJsonObject& operator=(const BasicJsonObject&);
 
-    JsonObject(JsonObject&&) = delete;
-    JsonObject& operator=(JsonObject&&) = delete;
+    BasicJsonObject(BasicJsonObject&&) = delete;
+    BasicJsonObject& operator=(BasicJsonObject&&) = delete;
 
     /**
      * @brief Outputs a JSON object from its vector of JsonPairs
@@ -54,7 +104,17 @@ public:
      *        which is not a json object in itself, but an entry in a json object.
      * @return JSON object from its vector of JsonPairs
      */
-    nlohmann::json toJson() const;
+    Json toJson() const;
+
+    /**
+     * @brief Outputs a JSON object with the fields selected by the projection only,
+     *        the other fields are skipped before their values are converted.
+     *        Nested JsonObjects output the fields selected by the sub-paths.
+     *        Selected keys that are not fields are taken from the unknown keys
+     *        (see setKeepUnknownKeys), if any. With an ordered Json type, the keys
+     *        are written in the order of the projection.
+     */
+    Json toJson(const FieldProjection& projection) const;
 
     /**
      * @brief Converts a given JSON to the internal values.
@@ -75,7 +135,32 @@ public:
      * @param jsonConfig the JSON from which to import the values
      * @return true if all pairs succeeded populating their values from JSON
      */
-    bool refreshFromJson(const nlohmann::json& jsonConfig);
+    bool refreshFromJson(const Json& jsonConfig);
+
+    /**
+     * @brief Same as refreshFromJson(const Json&), except that Lazy members (also
+     *        in nested objects and containers) keep a reference to their value in
+     *        the document instead of a copy. The document is kept alive as long
+     *        as one of them references it.
+     */
+    bool refreshFromJson(const std::shared_ptr<const Json>& document);
+
+    /**
+     * @brief 64-bit hash of the keys and values of all fields, computed from the
+     *        bound variables without converting to JSON. Nested JsonObjects,
+     *        containers and optionals are hashed recursively. The value is stable
+     *        across processes and builds for the same schema, but it is not a
+     *        hash of the JSON text. Empty optionals contribute to the hash.
+     */
+    std::uint64_t fingerprint() const;
+
+    /**
+     * @brief Field by field comparison: equal if both objects have the same keys,
+     *        bound types and values, in the same order. Objects that compare equal
+     *        have the same fingerprint.
+     */
+    bool operator==(const BasicJsonObject& other) const;
+    bool operator!=(const BasicJsonObject& other) const;
 
     /**
      * @brief Set data mutex to protect read/writes of data. When a mutex is
@@ -85,16 +170,295 @@ public:
      */
     void setDataMutex(std::mutex* dataMutex);
 
+    /**
+     * @brief When enabled, refreshFromJson stores the keys of the given JSON that
+     *        are not fields of this object, with their values, and toJson writes
+     *        them back after the fields. The stored keys are replaced on each
+     *        refreshFromJson and are part of comparisons and of the fingerprint.
+     *        They are copied with the object, but not written by the columnar
+     *        conversions. Disabled by default, the setting is copied with them.
+     *        It applies to the nested JsonObjects (members and container elements)
+     *        while they are refreshed with this object, whatever their own setting.
+     *        Set under the data mutex.
+     */
+    void setKeepUnknownKeys(bool keep);
+    bool keepsUnknownKeys() const;
+
+    /**
+     * @return the keys stored by refreshFromJson (see setKeepUnknownKeys):
+     *         a JSON object, or null if there are none
+     */
+    const Json& getUnknownKeys() const;
+    void clearUnknownKeys();
+
+    /**
+     * @brief When enabled, cachedJson and cachedDump keep the last converted JSON
+     *        and its text, stamped with the generation of the object, and return
+     *        them until the generation changes. Readers share the same immutable
+     *        buffers. Disabled by default, the setting is kept by copies (not the
+     *        cached values). Enable it before the object is shared between threads.
+     */
+    void setSerializationCache(bool enable);
+    bool hasSerializationCache() const;
+
+    /**
+     * @brief Counter of the changes of the object, incremented by refreshFromJson,
+     *        refreshFromColumns, set, clearUnknownKeys, copy assignment and
+     *        invalidate. Changes made directly to the members, or through the
+     *        pointers returned by get, getByPointer or nested objects, are not
+     *        counted: call invalidate() after them. Always 0 without cache.
+     */
+    std::uint64_t generation() const;
+    void invalidate();
+
+    /**
+     * @return toJson(), converted again only if the generation changed since the
+     *         last call (a new conversion on each call without cache)
+     */
+    std::shared_ptr<const Json> cachedJson() const;
+
+    /**
+     * @return toJson().dump(), converted again only if the generation changed since
+     *         the last call (a new conversion on each call without cache)
+     */
+    std::shared_ptr<const typename Json::string_t> cachedDump() const;
+
+    SerializationCacheStats serializationCacheStats() const;
+
+    /**
+     * @brief Position of a field in the JsonPair vector. The objects with the same
+     *        keys share the positions, so a position looked up once gives direct
+     *        access to that field of any object of the same derived class, as long
+     *        as its pairs do not depend on the arguments of its constructor.
+     *        Keys are looked up in a hash index built once per derived class (or
+     *        per sequence of keys), on the first lookup of any of its objects, so
+     *        that lookups in new objects do not allocate.
+     *
+     * @return std::nullopt if there is no field with that key
+     */
+    std::optional<std::size_t> fieldIndex(std::string_view key) const;
+
+    /**
+     * @brief Typed access to the variable bound to a field, by key or by position.
+     *        T must be the exact type of the bound variable, e.g. std::optional<T>
+     *        for optional fields. The data mutex is not locked: like with direct
+     *        member access, the caller is responsible for synchronization.
+     *
+     * @return nullptr if the field does not exist or is of another type
+     */
+    template<typename T>
+    const T* get(std::string_view key) const
+    {
+        const auto index = fieldIndex(key);
+        return index ? mPairs[*index].template getIf<T>() : nullptr;
+    }
+    template<typename T>
+    T* get(std::string_view key)
+    {
+        const auto index = fieldIndex(key);
+        return index ? mPairs[*index].template getMutableIf<T>() : nullptr;
+    }
+    template<typename T>
+    const T* get(std::size_t index) const
+    {
+        return index < mPairs.size() ? mPairs[index].template getIf<T>() : nullptr;
+    }
+    template<typename T>
+    T* get(std::size_t index)
+    {
+        return index < mPairs.size() ? mPairs[index].template getMutableIf<T>() : nullptr;
+    }
+
+    /**
+     * @brief Assigns a value to the variable bound to a field, locking the data mutex.
+     *        T must be the exact type of the bound variable.
+     *
+     * @return false if the field does not exist or is of another type
+     */
+    template<typename T>
+    bool set(std::string_view key, const T& value)
+    {
+        const auto index = fieldIndex(key);
+        if (!index)
+        {
+            return false;
+        }
+        LockGuard lk = lockData();
+        auto* field  = mPairs[*index].template getMutableIf<T>();
+        if (field == nullptr)
+        {
+            return false;
+        }
+        *field = value;
+        invalidate();
+        return true;
+    }
+
+    /**
+     * @brief Typed access to a field of this object or of a nested one, with
+     *        a JSON Pointer (RFC 6901), e.g. "/contact_list/0/name". Nested
+     *        objects are reached through JsonObject members (optional or not),
+     *        sequence containers of JsonObjects (by index) and maps of
+     *        JsonObjects (by key). The last token must name a field.
+     *
+     * @return nullptr if the path cannot be resolved or the field is of another type
+     */
+    template<typename T>
+    const T* getByPointer(std::string_view pointer) const
+    {
+        const auto* pair = findPairByPointer(pointer);
+        return pair != nullptr ? pair->template getIf<T>() : nullptr;
+    }
+    template<typename T>
+    T* getByPointer(std::string_view pointer)
+    {
+        auto* pair = findPairByPointer(pointer);
+        return pair != nullptr ? pair->template getMutableIf<T>() : nullptr;
+    }
+
+    /**
+     * @brief Calls visitor(const JsonPair&) for each field, in declaration order.
+     *        The JsonPair gives the key, the bound type and typed access to the
+     *        variable (see JsonPair::getIf). The data mutex is not locked.
+     */
+    template<typename Visitor>
+    void visitFields(Visitor&& visitor) const
+    {
+        for (const auto& p : mPairs)
+        {
+            visitor(p);
+        }
+    }
+
 private:
-    std::vector<JsonPair> mPairs;
+    // The columnar conversions (see JsonColumnar.hpp)
+    friend struct ColumnarAccess;
+    friend struct ObjectReset<Json>;
+
+    using LockGuard = std::unique_lock<std::mutex>;
+
+    /**
+     * Positions of the keys of a class, owning the keys that the views point to.
+     * Built once per class and never released (see keyIndex).
+     */
+    struct KeyIndex
+    {
+        std::vector<std::string> keys;
+        std::unordered_map<std::string_view, std::size_t> positions;
+    };
+
+    std::vector<Pair> mPairs;
 
     std::mutex* mDataMutex{nullptr};
 
-    void updateAddresses(const JsonObject& origin);
+    // Index of the class of this object, set on its first lookup or by copy
+    mutable std::atomic<const KeyIndex*> mKeyIndex{nullptr};
+
+    bool mKeepUnknownKeys{false};
+    Json mUnknownKeys;
+
+    // Set while an object that keeps its unknown keys refreshes its fields
+    inline static thread_local bool keepingUnknownKeys = false;
+
+    /**
+     * The generation is incremented without locking the cache mutex, so that
+     * writers holding the data mutex never wait for a reader serializing.
+     */
+    struct SerializationCache
+    {
+        std::atomic<std::uint64_t> generation{0};
+        std::mutex mutex;
+        std::uint64_t cachedGeneration{0};
+        std::shared_ptr<const Json> json;
+        std::shared_ptr<const typename Json::string_t> text;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+    };
+    std::unique_ptr<SerializationCache> mSerializationCache;
+
+    void refreshCachedJson(SerializationCache& cache) const;
+
+    void storeUnknownKeys(const Json& jsonConfig);
+
+    /**
+     * @brief Resets the fields to the ones of defaults, an object of the same class,
+     *        keeping their capacity (see resetValue). The unknown keys are cleared,
+     *        members that are not fields are left unchanged.
+     */
+    void resetFields(const BasicJsonObject& defaults);
+
+    /**
+     * @brief Appends the value of each field to the column at the same position,
+     *        null for empty optionals.
+     *
+     * @param columns one array per field, in declaration order
+     */
+    void appendToColumns(std::vector<typename Json::array_t>& columns) const;
+
+    /**
+     * @brief As appendToColumns, for the fields selected by the projection only.
+     *
+     * @param columns one array per selected field, in the order of the projection
+     */
+    void appendToColumns(std::vector<typename Json::array_t>& columns, const FieldProjection& projection) const;
+
+    /**
+     * @brief Converts one row of columnar JSON to the internal values,
+     *        with the same checks as refreshFromJson.
+     *
+     * @param columns one array per field, in declaration order, or nullptr
+     *                for fields that are not provided
+     * @param row     position of this object in the columns
+     * @return true if all pairs succeeded populating their values from JSON
+     */
+    bool refreshFromColumns(const std::vector<const typename Json::array_t*>& columns, std::size_t row);
+
+    void updateAddresses(const BasicJsonObject& origin);
+
+    LockGuard lockData() const;
+
+    const KeyIndex& keyIndex() const;
+
+    /**
+     * @return the positions of the fields selected by the projection in this class,
+     *         FieldProjection::npos for keys that are not fields
+     */
+    const std::vector<std::size_t>& projectedPositions(const FieldProjection& projection) const;
+
+    const Pair* findPairByPointer(std::string_view pointer) const;
+    Pair* findPairByPointer(std::string_view pointer);
 };
 
-void to_json(nlohmann::json& j, const JsonObject& joc);
-void from_json(const nlohmann::json& j, JsonObject& joc);
+using JsonObject        = BasicJsonObject<nlohmann::json>;
+using OrderedJsonObject = BasicJsonObject<nlohmann::ordered_json>;
+
+/**
+ * @brief Reset of the JsonObjects held by fields and recycled by JsonObjectPool.
+ */
+template<typename Json>
+struct ObjectReset
+{
+    static void reset(BasicJsonObject<Json>& object, const BasicJsonObject<Json>& defaults)
+    {
+        object.resetFields(defaults);
+    }
+};
+
+template<typename Json>
+void to_json(Json& j, const BasicJsonObject<Json>& joc)
+{
+    j = joc.toJson();
+}
+
+template<typename Json>
+void from_json(const Json& j, BasicJsonObject<Json>& joc)
+{
+    joc.refreshFromJson(j);
+}
+
+// Compiled in joclib, see src/JsonObjectConverter.cpp
+extern template class BasicJsonObject<nlohmann::json>;
+extern template class BasicJsonObject<nlohmann::ordered_json>;
 
 } // namespace joc
 
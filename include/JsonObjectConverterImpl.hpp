@@ -0,0 +1,709 @@
+#ifndef JSONOBJECTCONVERTERIMPL_HPP_
+#define JSONOBJECTCONVERTERIMPL_HPP_
+
+/**
+ * Definitions of the BasicJsonObject member functions. joclib compiles them for
+ * nlohmann::json and nlohmann::ordered_json. Include this header instead of
+ * JsonObjectConverter.hpp to use BasicJsonObject with another basic_json
+ * specialization, e.g. one with custom number types.
+ */
+
+#include "JsonObjectConverter.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <typeindex>
+#include <typeinfo>
+
+namespace joc
+{
+
+/**
+ * @brief Decodes the "~1" and "~0" escapes of a JSON Pointer token.
+ *        Tokens without escapes are returned as they are, others are
+ *        decoded into the given buffer.
+ */
+inline std::string_view unescapePointerToken(std::string_view token, std::string& buffer)
+{
+    if (token.find('~') == std::string_view::npos)
+    {
+        return token;
+    }
+    buffer.clear();
+    for (std::size_t i = 0; i < token.size(); ++i)
+    {
+        if (token[i] == '~' && i + 1 < token.size() && (token[i + 1] == '0' || token[i + 1] == '1'))
+        {
+            buffer += token[i + 1] == '0' ? '~' : '/';
+            ++i;
+        }
+        else
+        {
+            buffer += token[i];
+        }
+    }
+    return buffer;
+}
+
+template<typename Json>
+BasicJsonObject<Json>::BasicJsonObject(const std::vector<Pair>& pairs, std::mutex* dataMutex)
+    : mPairs(pairs)
+    , mDataMutex(dataMutex)
+{
+}
+
+template<typename Json>
+BasicJsonObject<Json>::BasicJsonObject(const BasicJsonObject& other)
+    : mPairs(other.mPairs)
+    // we cannot reuse the mutex from another object, don't assign mDataMutex
+    , mKeyIndex(other.mKeyIndex.load(std::memory_order_acquire))
+    , mKeepUnknownKeys(other.mKeepUnknownKeys)
+    , mUnknownKeys(other.mUnknownKeys)
+    , mSerializationCache(other.mSerializationCache ? std::make_unique<SerializationCache>() : nullptr)
+{
+    updateAddresses(other);
+}
+
+template<typename Json>
+BasicJsonObject<Json>& BasicJsonObject<Json>::operator=(const BasicJsonObject& other)
+{
+    // Skipping copy of mPairs as they already point to the members of the child classes of
+    // this object (created with other constructors)
+    if (this != &other)
+    {
+        // The child class assigns its members after this returns, so the generation is
+        // incremented before they change (see operator=)
+        mKeepUnknownKeys = other.mKeepUnknownKeys;
+        mUnknownKeys     = other.mUnknownKeys;
+        invalidate();
+    }
+    return *this;
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::setDataMutex(std::mutex* dataMutex)
+{
+    mDataMutex = dataMutex;
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::setKeepUnknownKeys(bool keep)
+{
+    auto lk          = lockData();
+    mKeepUnknownKeys = keep;
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::keepsUnknownKeys() const
+{
+    auto lk = lockData();
+    return mKeepUnknownKeys;
+}
+
+template<typename Json>
+const Json& BasicJsonObject<Json>::getUnknownKeys() const
+{
+    return mUnknownKeys;
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::clearUnknownKeys()
+{
+    auto lk      = lockData();
+    mUnknownKeys = nullptr;
+    invalidate();
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::setSerializationCache(bool enable)
+{
+    if (!enable)
+    {
+        mSerializationCache.reset();
+    }
+    else if (!mSerializationCache)
+    {
+        mSerializationCache = std::make_unique<SerializationCache>();
+    }
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::hasSerializationCache() const
+{
+    return mSerializationCache != nullptr;
+}
+
+template<typename Json>
+std::uint64_t BasicJsonObject<Json>::generation() const
+{
+    return mSerializationCache ? mSerializationCache->generation.load(std::memory_order_acquire) : 0;
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::invalidate()
+{
+    if (mSerializationCache)
+    {
+        mSerializationCache->generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::refreshCachedJson(SerializationCache& cache) const
+{
+    // Read before converting: a change made meanwhile makes the next call convert again
+    cache.cachedGeneration = cache.generation.load(std::memory_order_acquire);
+    cache.json             = std::make_shared<const Json>(toJson());
+    cache.text.reset();
+}
+
+template<typename Json>
+std::shared_ptr<const Json> BasicJsonObject<Json>::cachedJson() const
+{
+    if (!mSerializationCache)
+    {
+        return std::make_shared<const Json>(toJson());
+    }
+    auto& cache = *mSerializationCache;
+
+    std::lock_guard<std::mutex> lk(cache.mutex);
+    if (cache.json && cache.cachedGeneration == cache.generation.load(std::memory_order_acquire))
+    {
+        cache.hits.fetch_add(1, std::memory_order_relaxed);
+        return cache.json;
+    }
+    cache.misses.fetch_add(1, std::memory_order_relaxed);
+    refreshCachedJson(cache);
+    return cache.json;
+}
+
+template<typename Json>
+std::shared_ptr<const typename Json::string_t> BasicJsonObject<Json>::cachedDump() const
+{
+    if (!mSerializationCache)
+    {
+        return std::make_shared<const typename Json::string_t>(toJson().dump());
+    }
+    auto& cache = *mSerializationCache;
+
+    std::lock_guard<std::mutex> lk(cache.mutex);
+    const bool upToDate = cache.json && cache.cachedGeneration == cache.generation.load(std::memory_order_acquire);
+    if (upToDate && cache.text)
+    {
+        cache.hits.fetch_add(1, std::memory_order_relaxed);
+        return cache.text;
+    }
+    cache.misses.fetch_add(1, std::memory_order_relaxed);
+    if (!upToDate)
+    {
+        refreshCachedJson(cache);
+    }
+    cache.text = std::make_shared<const typename Json::string_t>(cache.json->dump());
+    return cache.text;
+}
+
+template<typename Json>
+typename BasicJsonObject<Json>::SerializationCacheStats BasicJsonObject<Json>::serializationCacheStats() const
+{
+    if (!mSerializationCache)
+    {
+        return {};
+    }
+    return {mSerializationCache->hits.load(std::memory_order_relaxed),
+            mSerializationCache->misses.load(std::memory_order_relaxed)};
+}
+
+template<typename Json>
+typename BasicJsonObject<Json>::LockGuard BasicJsonObject<Json>::lockData() const
+{
+    return (mDataMutex == nullptr) ? LockGuard() : LockGuard(*mDataMutex);
+}
+
+template<typename Json>
+std::uint64_t BasicJsonObject<Json>::fingerprint() const
+{
+    FingerprintHasher hasher;
+
+    auto lk = lockData();
+    for (const auto& p : mPairs)
+    {
+        p.hash(hasher);
+    }
+    hasher.update(mPairs.size());
+    if (mUnknownKeys.is_object())
+    {
+        hashValue<Json>(hasher, mUnknownKeys);
+    }
+    return hasher.digest();
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::operator==(const BasicJsonObject& other) const
+{
+    if (this == &other)
+    {
+        return true;
+    }
+
+    auto lk      = (mDataMutex == nullptr) ? LockGuard() : LockGuard(*mDataMutex, std::defer_lock);
+    auto otherLk = (other.mDataMutex == nullptr || other.mDataMutex == mDataMutex)
+                       ? LockGuard()
+                       : LockGuard(*other.mDataMutex, std::defer_lock);
+    if (lk.mutex() != nullptr && otherLk.mutex() != nullptr)
+    {
+        std::lock(lk, otherLk);
+    }
+    else if (lk.mutex() != nullptr)
+    {
+        lk.lock();
+    }
+    else if (otherLk.mutex() != nullptr)
+    {
+        otherLk.lock();
+    }
+
+    if (mPairs.size() != other.mPairs.size() || mUnknownKeys != other.mUnknownKeys)
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < mPairs.size(); ++i)
+    {
+        if (!mPairs[i].equals(other.mPairs[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::operator!=(const BasicJsonObject& other) const
+{
+    return !(*this == other);
+}
+
+template<typename Json>
+std::optional<std::size_t> BasicJsonObject<Json>::fieldIndex(std::string_view key) const
+{
+    const auto& positions = keyIndex().positions;
+    const auto it         = positions.find(key);
+    if (it == positions.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+/**
+ * The indexes are registered by derived class, as the objects of a class usually have
+ * the same keys: the index of the class is used when it has the keys of this object.
+ * Objects of BasicJsonObject itself, and objects whose keys depend on the arguments
+ * of their constructor, are registered by their sequence of keys instead.
+ */
+template<typename Json>
+const typename BasicJsonObject<Json>::KeyIndex& BasicJsonObject<Json>::keyIndex() const
+{
+    const auto* cached = mKeyIndex.load(std::memory_order_acquire);
+    if (cached != nullptr)
+    {
+        return *cached;
+    }
+
+    struct Registry
+    {
+        std::shared_mutex mutex;
+        std::unordered_map<std::type_index, std::unique_ptr<const KeyIndex>> byClass;
+        std::map<std::vector<std::string>, std::unique_ptr<const KeyIndex>> byKeys;
+    };
+    static Registry registry;
+
+    const auto hasKeysOf = [this](const KeyIndex& index) {
+        if (index.keys.size() != mPairs.size())
+        {
+            return false;
+        }
+        for (std::size_t i = 0; i < mPairs.size(); ++i)
+        {
+            if (index.keys[i] != mPairs[i].getName())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    const std::type_index type(typeid(*this));
+    const bool hasClass = type != std::type_index(typeid(BasicJsonObject));
+
+    const KeyIndex* found = nullptr;
+    if (hasClass)
+    {
+        std::shared_lock<std::shared_mutex> lk(registry.mutex);
+        const auto it = registry.byClass.find(type);
+        if (it != registry.byClass.end() && hasKeysOf(*it->second))
+        {
+            found = it->second.get();
+        }
+    }
+
+    if (found == nullptr)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(mPairs.size());
+        for (const auto& p : mPairs)
+        {
+            keys.push_back(p.getName());
+        }
+        {
+            std::shared_lock<std::shared_mutex> lk(registry.mutex);
+            const auto it = registry.byKeys.find(keys);
+            found         = it != registry.byKeys.end() ? it->second.get() : nullptr;
+        }
+
+        if (found == nullptr)
+        {
+            auto built  = std::make_unique<KeyIndex>();
+            built->keys = std::move(keys);
+            built->positions.reserve(built->keys.size());
+            for (std::size_t i = 0; i < built->keys.size(); ++i)
+            {
+                built->positions.emplace(built->keys[i], i);
+            }
+
+            // Another thread may have registered the class or the keys meanwhile, their index is kept
+            std::unique_lock<std::shared_mutex> lk(registry.mutex);
+            if (hasClass)
+            {
+                auto& entry = registry.byClass[type];
+                if (!entry)
+                {
+                    entry = std::move(built);
+                }
+                if (hasKeysOf(*entry))
+                {
+                    found = entry.get();
+                }
+            }
+            if (found == nullptr)
+            {
+                // built was not taken by the class
+                auto& entry = registry.byKeys[built->keys];
+                if (!entry)
+                {
+                    entry = std::move(built);
+                }
+                found = entry.get();
+            }
+        }
+    }
+
+    mKeyIndex.store(found, std::memory_order_release);
+    return *found;
+}
+
+template<typename Json>
+const std::vector<std::size_t>& BasicJsonObject<Json>::projectedPositions(const FieldProjection& projection) const
+{
+    // The key index identifies the keys of the object, its positions are resolved once per projection
+    return projection.positions(&keyIndex(), [](const void* schema, std::string_view key) {
+        const auto& positions = static_cast<const KeyIndex*>(schema)->positions;
+        const auto it         = positions.find(key);
+        return it == positions.end() ? FieldProjection::npos : it->second;
+    });
+}
+
+template<typename Json>
+const typename BasicJsonObject<Json>::Pair* BasicJsonObject<Json>::findPairByPointer(std::string_view pointer) const
+{
+    if (pointer.empty() || pointer.front() != '/')
+    {
+        return nullptr;
+    }
+    pointer.remove_prefix(1);
+
+    std::string buffer;
+    const BasicJsonObject* object = this;
+    while (true)
+    {
+        auto separator   = pointer.find('/');
+        const auto index = object->fieldIndex(unescapePointerToken(pointer.substr(0, separator), buffer));
+        if (!index)
+        {
+            return nullptr;
+        }
+        const auto& pair = object->mPairs[*index];
+        if (separator == std::string_view::npos)
+        {
+            return &pair;
+        }
+        pointer.remove_prefix(separator + 1);
+
+        const BasicJsonObject* nested = pair.getNestedObject();
+        if (nested == nullptr)
+        {
+            // Containers take one more token to select the element
+            separator = pointer.find('/');
+            if (separator == std::string_view::npos)
+            {
+                return nullptr;
+            }
+            nested = pair.getNestedElement(unescapePointerToken(pointer.substr(0, separator), buffer));
+            if (nested == nullptr)
+            {
+                return nullptr;
+            }
+            pointer.remove_prefix(separator + 1);
+        }
+        object = nested;
+    }
+}
+
+template<typename Json>
+typename BasicJsonObject<Json>::Pair* BasicJsonObject<Json>::findPairByPointer(std::string_view pointer)
+{
+    return const_cast<Pair*>(static_cast<const BasicJsonObject*>(this)->findPairByPointer(pointer));
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::updateAddresses(const BasicJsonObject& origin)
+{
+    auto ptrInt      = reinterpret_cast<std::uintptr_t>(static_cast<BasicJsonObject*>(this));
+    auto otherPtrInt = reinterpret_cast<std::uintptr_t>(static_cast<const BasicJsonObject*>(&origin));
+    std::uintptr_t diff;
+    if (ptrInt > otherPtrInt)
+    {
+        diff = ptrInt - otherPtrInt;
+    }
+    else
+    {
+        diff = otherPtrInt - ptrInt;
+    }
+
+    for (size_t i = 0; i < mPairs.size(); ++i)
+    {
+        if (ptrInt > otherPtrInt)
+        {
+            mPairs[i].setAddress(
+                reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(origin.mPairs[i].getMutableAddress()) + diff));
+        }
+        else
+        {
+            mPairs[i].setAddress(
+                reinterpret_cast<void*>(reinterpret_cast<std::uintptr_t>(origin.mPairs[i].getMutableAddress()) - diff));
+        }
+    }
+}
+
+template<typename Json>
+Json BasicJsonObject<Json>::toJson() const
+{
+    auto jsonConfig = Json::object();
+
+    auto lk = lockData();
+    for (const auto& p : mPairs)
+    {
+        if (p.hasValue())
+        {
+            jsonConfig += p.toJson();
+        }
+    }
+    if (mUnknownKeys.is_object())
+    {
+        for (auto it = mUnknownKeys.begin(); it != mUnknownKeys.end(); ++it)
+        {
+            jsonConfig[it.key()] = it.value();
+        }
+    }
+    return jsonConfig;
+}
+
+template<typename Json>
+Json BasicJsonObject<Json>::toJson(const FieldProjection& projection) const
+{
+    auto jsonConfig = Json::object();
+
+    const auto& fields    = projection.fields();
+    const auto& positions = projectedPositions(projection);
+
+    auto lk = lockData();
+    for (std::size_t f = 0; f < fields.size(); ++f)
+    {
+        const auto& field = fields[f];
+        if (positions[f] == FieldProjection::npos)
+        {
+            if (mUnknownKeys.is_object())
+            {
+                const auto it = mUnknownKeys.find(field.key);
+                if (it != mUnknownKeys.end())
+                {
+                    jsonConfig[field.key] = *it;
+                }
+            }
+            continue;
+        }
+
+        const auto& p = mPairs[positions[f]];
+        if (p.hasValue())
+        {
+            jsonConfig[field.key] = field.whole ? p.toJsonValue() : p.toJsonValue(field.nested);
+        }
+    }
+    return jsonConfig;
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::refreshFromJson(const Json& jsonConfig)
+{
+    if (jsonConfig.empty())
+    {
+        return false;
+    }
+    auto success = true;
+    // The Lazy members reference jsonConfig if it is part of a shared document
+    const typename LazyDocumentScope<Json>::Value documentValue(jsonConfig);
+
+    auto lk = lockData();
+
+    // The nested objects refreshed meanwhile keep their unknown keys too
+    const bool keepUnknownKeys = mKeepUnknownKeys || keepingUnknownKeys;
+    struct KeepingScope
+    {
+        const bool previous = keepingUnknownKeys;
+        ~KeepingScope()
+        {
+            keepingUnknownKeys = previous;
+        }
+    } keepingScope;
+    keepingUnknownKeys = keepUnknownKeys;
+
+    for (auto& p : mPairs)
+    {
+        if (!p.refreshFromJson(jsonConfig))
+        {
+            success = false;
+        }
+    }
+    if (keepUnknownKeys)
+    {
+        storeUnknownKeys(jsonConfig);
+    }
+    else if (!mUnknownKeys.is_null())
+    {
+        mUnknownKeys = nullptr;
+    }
+    invalidate();
+    return success;
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::refreshFromJson(const std::shared_ptr<const Json>& document)
+{
+    if (!document)
+    {
+        return false;
+    }
+    const LazyDocumentScope<Json> scope(document);
+    return refreshFromJson(*document);
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::storeUnknownKeys(const Json& jsonConfig)
+{
+    mUnknownKeys = nullptr;
+    if (!jsonConfig.is_object())
+    {
+        return;
+    }
+    for (auto it = jsonConfig.begin(); it != jsonConfig.end(); ++it)
+    {
+        const auto& key = it.key();
+        if (!fieldIndex(std::string_view(key.data(), key.size())))
+        {
+            mUnknownKeys[key] = it.value();
+        }
+    }
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::resetFields(const BasicJsonObject& defaults)
+{
+    auto lk = lockData();
+    for (std::size_t i = 0; i < mPairs.size() && i < defaults.mPairs.size(); ++i)
+    {
+        mPairs[i].resetFrom(defaults.mPairs[i]);
+    }
+    mUnknownKeys = nullptr;
+    invalidate();
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::appendToColumns(std::vector<typename Json::array_t>& columns) const
+{
+    auto lk = lockData();
+    for (std::size_t i = 0; i < mPairs.size() && i < columns.size(); ++i)
+    {
+        if (mPairs[i].hasValue())
+        {
+            columns[i].push_back(mPairs[i].toJsonValue());
+        }
+        else
+        {
+            columns[i].emplace_back(nullptr);
+        }
+    }
+}
+
+template<typename Json>
+void BasicJsonObject<Json>::appendToColumns(std::vector<typename Json::array_t>& columns,
+                                            const FieldProjection& projection) const
+{
+    const auto& fields    = projection.fields();
+    const auto& positions = projectedPositions(projection);
+
+    auto lk = lockData();
+    std::size_t column = 0;
+    for (std::size_t f = 0; f < fields.size(); ++f)
+    {
+        const auto& field = fields[f];
+        if (positions[f] == FieldProjection::npos || column >= columns.size())
+        {
+            continue;
+        }
+        const auto& p = mPairs[positions[f]];
+        if (!p.hasValue())
+        {
+            columns[column].emplace_back(nullptr);
+        }
+        else
+        {
+            columns[column].push_back(field.whole ? p.toJsonValue() : p.toJsonValue(field.nested));
+        }
+        ++column;
+    }
+}
+
+template<typename Json>
+bool BasicJsonObject<Json>::refreshFromColumns(const std::vector<const typename Json::array_t*>& columns,
+                                               std::size_t row)
+{
+    auto success = true;
+
+    auto lk = lockData();
+    for (std::size_t i = 0; i < mPairs.size(); ++i)
+    {
+        const auto* column = i < columns.size() ? columns[i] : nullptr;
+        const bool valid   = (column != nullptr && row < column->size()) ? mPairs[i].refreshFromJsonValue((*column)[row])
+                                                                         : mPairs[i].notProvided();
+        if (!valid)
+        {
+            success = false;
+        }
+    }
+    invalidate();
+    return success;
+}
+} // namespace joc
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef JSON_JSONOBJECTPOOL_HPP_
+#define JSON_JSONOBJECTPOOL_HPP_
+
+#include "JsonObjectConverter.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace joc
+{
+/**
+ * @brief Recycles objects of a JsonObject type T, to avoid constructing a new
+ *        object (and its vector of JsonPairs) per conversion, e.g.:
+ *
+ *          auto request = JsonObjectPool<Request>::threadLocal().acquire();
+ *          request->refreshFromJson(body);
+ *          handle(*request);
+ *          // back to the pool when request goes out of scope
+ *
+ *        The fields of the objects are reset to the ones of a default constructed T
+ *        when they return to the pool: containers get back their default elements,
+ *        and strings and vectors keep their capacity, so converting messages of
+ *        similar size into recycled objects allocates less. Members that are not
+ *        fields are not reset.
+ *
+ *        A pool is not thread-safe. Multithreaded code uses one pool per thread,
+ *        e.g. threadLocal(), and releases the handles in the thread that acquired
+ *        them. The pool must outlive its handles.
+ */
+template<typename T>
+class JsonObjectPool
+{
+    static_assert(std::is_base_of_v<BasicJsonObject<typename T::JsonType>, T>, "T must be a JsonObject type");
+
+public:
+    /**
+     * @brief Owner of an object acquired from the pool, returns it to the pool
+     *        on destruction or reset().
+     */
+    class Handle
+    {
+    public:
+        Handle() = default;
+        ~Handle()
+        {
+            reset();
+        }
+
+        Handle(Handle&& other) noexcept
+            : mPool(std::exchange(other.mPool, nullptr))
+            , mObject(std::move(other.mObject))
+        {
+        }
+        Handle& operator=(Handle&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                mPool   = std::exchange(other.mPool, nullptr);
+                mObject = std::move(other.mObject);
+            }
+            return *this;
+        }
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        T* get() const
+        {
+            return mObject.get();
+        }
+        T& operator*() const
+        {
+            return *mObject;
+        }
+        T* operator->() const
+        {
+            return mObject.get();
+        }
+        explicit operator bool() const
+        {
+            return mObject != nullptr;
+        }
+
+        /**
+         * @brief Returns the object to the pool, the handle becomes empty.
+         */
+        void reset()
+        {
+            if (mObject)
+            {
+                mPool->recycle(std::move(mObject));
+            }
+            mPool = nullptr;
+        }
+
+    private:
+        friend class JsonObjectPool;
+
+        Handle(JsonObjectPool* pool, std::unique_ptr<T> object)
+            : mPool(pool)
+            , mObject(std::move(object))
+        {
+        }
+
+        JsonObjectPool* mPool{nullptr};
+        std::unique_ptr<T> mObject;
+    };
+
+    /**
+     * @param maxIdle number of released objects kept for reuse, further ones are destroyed
+     */
+    explicit JsonObjectPool(std::size_t maxIdle = DEFAULT_MAX_IDLE)
+        : mMaxIdle(maxIdle)
+    {
+    }
+
+    JsonObjectPool(const JsonObjectPool&) = delete;
+    JsonObjectPool& operator=(const JsonObjectPool&) = delete;
+
+    /**
+     * @return an object with default values, recycled if available
+     */
+    Handle acquire()
+    {
+        if (mIdle.empty())
+        {
+            return Handle(this, std::make_unique<T>());
+        }
+        auto object = std::move(mIdle.back());
+        mIdle.pop_back();
+        return Handle(this, std::move(object));
+    }
+
+    /**
+     * @brief Constructs objects up to count idle ones (at most maxIdle), so that
+     *        the first acquisitions do not construct.
+     */
+    void reserve(std::size_t count)
+    {
+        count = std::min(count, mMaxIdle);
+        mIdle.reserve(count);
+        while (mIdle.size() < count)
+        {
+            mIdle.push_back(std::make_unique<T>());
+        }
+    }
+
+    std::size_t idle() const
+    {
+        return mIdle.size();
+    }
+
+    /**
+     * @return the pool of the calling thread, destroyed when the thread exits
+     */
+    static JsonObjectPool& threadLocal()
+    {
+        thread_local JsonObjectPool pool;
+        return pool;
+    }
+
+    static constexpr std::size_t DEFAULT_MAX_IDLE = 16;
+
+private:
+    void recycle(std::unique_ptr<T> object)
+    {
+        if (mIdle.size() >= mMaxIdle)
+        {
+            return;
+        }
+        resetValue<typename T::JsonType>(*object, defaultInstance<T>());
+        mIdle.push_back(std::move(object));
+    }
+
+    std::vector<std::unique_ptr<T>> mIdle;
+    std::size_t mMaxIdle;
+};
+
+} // namespace joc
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef JSON_JSONPAIRCONVERTER_HPP_
 #define JSON_JSONPAIRCONVERTER_HPP_
 
+#include "JsonFingerprint.hpp"
+#include "JsonLazy.hpp"
 #include "JsonPairConverterHelper.hpp"
 
 #include "nlohmann/json.hpp"
@@ -9,13 +11,49 @@
 #include <iostream>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <typeinfo>
 
 namespace joc
 {
 
-class JsonPair
+/**
+ * Operations on a bound value of type T that do not depend on the field: one
+ * table per type, shared by the pairs bound to that type.
+ */
+template<typename Json>
+struct ValueOperations
+{
+    const std::type_info* type;
+    BasicJsonObject<Json>* (*nestedObject)(void*);
+    BasicJsonObject<Json>* (*nestedElement)(void*, std::string_view);
+    void (*hash)(FingerprintHasher&, const void*);
+    bool (*equals)(const void*, const void*);
+    void (*reset)(void*, const void*);
+    ProjectedToJsonFunction<Json> projectedToJson;
+};
+
+template<typename Json, typename T>
+inline constexpr ValueOperations<Json> valueOperations{
+    &typeid(T),
+    NestedObjectAccess<Json, T>::object,
+    NestedObjectAccess<Json, T>::element,
+    templateHash<Json, T>,
+    templateEquals<Json, T>,
+    templateReset<Json, T>,
+    ProjectedConversion<Json, T>::function,
+};
+
+/**
+ * @brief Binding between a key and a C++ variable, converted with the
+ *        nlohmann::basic_json specialization Json (see JsonPair and OrderedJsonPair).
+ */
+template<typename Json>
+class BasicJsonPair
 {
 public:
+    using JsonType = Json;
+
     /**
      * @brief Typical constructor for most common T variables
      *        Examples of types supported: booleans, numbers and strings.
@@ -25,67 +63,194 @@ public:
      *                    where to write.
      */
     template<typename T>
-    JsonPair(const std::string& name, T& value)
+    BasicJsonPair(const std::string& name, T& value)
         : mIsOptional(false)
         , mAddress(static_cast<void*>(&value))
         , mName(name)
-        , mToJsonFunction(templateToJson<T>)
-        , mIsJsonValidFunction(templateIsJsonValid<T>)
+        , mToJsonFunction(templateToJson<Json, T>)
+        , mIsJsonValidFunction(templateIsJsonValid<Json, T>)
         , mHasValueFunction([](const void*) { return true; })
-        , mFromJsonFunction(templateFromJson<T>)
+        , mFromJsonFunction(templateFromJson<Json, T>)
+        , mOperations(&valueOperations<Json, T>)
     {
+        static_assert(!IsLazyOfOtherJson<T, Json>::value, "Lazy must use the JSON type of the JsonObject");
     }
     template<typename T>
-    JsonPair(const std::string& name, std::optional<T>& value)
+    BasicJsonPair(const std::string& name, std::optional<T>& value)
         : mIsOptional(true)
         , mAddress(static_cast<void*>(&value))
         , mName(name)
-        , mToJsonFunction(templateOptionalToJson<T>)
-        , mIsJsonValidFunction(templateIsJsonValid<T>)
+        , mToJsonFunction(templateOptionalToJson<Json, T>)
+        , mIsJsonValidFunction(templateIsJsonValid<Json, T>)
         , mHasValueFunction(
               [](const void* address) { return static_cast<const std::optional<T>*>(address)->has_value(); })
-        , mFromJsonFunction(templateOptionalFromJson<T>)
+        , mFromJsonFunction(templateOptionalFromJson<Json, T>)
+        , mOperations(&valueOperations<Json, std::optional<T>>)
     {
+        static_assert(!IsLazyOfOtherJson<T, Json>::value, "Lazy must use the JSON type of the JsonObject");
     }
 
-    bool refreshFromJson(const nlohmann::json& jsonConfig)
+    /**
+     * @brief Constructors for time points that select the JSON encoding of this
+     *        field only. Without the encoding argument, the time point is converted
+     *        with the encoding of its type (see TimestampEncodingOf).
+     *
+     * @param encoding    the representation of the time point in the JSON
+     */
+    template<typename Clock, typename Dur>
+    BasicJsonPair(const std::string& name, std::chrono::time_point<Clock, Dur>& value, TimestampEncoding encoding)
+        : mIsOptional(false)
+        , mAddress(static_cast<void*>(&value))
+        , mName(name)
+        , mToJsonFunction([encoding](const void* value) {
+            return templateTimestampToJson<Json, std::chrono::time_point<Clock, Dur>>(value, encoding);
+        })
+        , mIsJsonValidFunction(
+              [encoding](const Json& value) { return templateIsTimestampValid(value, encoding); })
+        , mHasValueFunction([](const void*) { return true; })
+        , mFromJsonFunction([encoding](const Json& value, void* out) {
+            return templateTimestampFromJson<Json, std::chrono::time_point<Clock, Dur>>(value, out, encoding);
+        })
+        , mOperations(&valueOperations<Json, std::chrono::time_point<Clock, Dur>>)
     {
-        bool isValid = true;
-        std::string errorMsg;
+    }
+    template<typename Clock, typename Dur>
+    BasicJsonPair(const std::string& name,
+             std::optional<std::chrono::time_point<Clock, Dur>>& value,
+             TimestampEncoding encoding)
+        : mIsOptional(true)
+        , mAddress(static_cast<void*>(&value))
+        , mName(name)
+        , mToJsonFunction([encoding](const void* optional) {
+            return templateOptionalTimestampToJson<Json, std::chrono::time_point<Clock, Dur>>(optional, encoding);
+        })
+        , mIsJsonValidFunction(
+              [encoding](const Json& value) { return templateIsTimestampValid(value, encoding); })
+        , mHasValueFunction([](const void* address) {
+            return static_cast<const std::optional<std::chrono::time_point<Clock, Dur>>*>(address)->has_value();
+        })
+        , mFromJsonFunction([encoding](const Json& value, void* optional) {
+            return templateOptionalTimestampFromJson<Json, std::chrono::time_point<Clock, Dur>>(value, optional, encoding);
+        })
+        , mOperations(&valueOperations<Json, std::optional<std::chrono::time_point<Clock, Dur>>>)
+    {
+    }
 
-        const bool explicitNullOpt = mIsOptional && jsonConfig.contains(mName) && jsonConfig[mName].is_null();
-        if (explicitNullOpt)
-        {
-            // It is valid
-        }
-        else
+    /**
+     * @brief Constructors for numeric arrays (std::vector or std::array of numbers)
+     *        that select the JSON encoding of this field. Without the encoding
+     *        argument, the array is converted to a JSON array of numbers.
+     *
+     * @param encoding    the representation of the array in the JSON
+     */
+    template<typename T, typename = std::enable_if_t<IsNumericArray<T>::value>>
+    BasicJsonPair(const std::string& name, T& value, NumericArrayEncoding encoding)
+        : mIsOptional(false)
+        , mAddress(static_cast<void*>(&value))
+        , mName(name)
+        , mToJsonFunction(
+              [encoding](const void* value) { return templateNumericArrayToJson<Json, T>(value, encoding); })
+        , mIsJsonValidFunction(
+              [encoding](const Json& value) { return templateIsNumericArrayValid(value, encoding); })
+        , mHasValueFunction([](const void*) { return true; })
+        , mFromJsonFunction([encoding](const Json& value, void* out) {
+            return templateNumericArrayFromJson<Json, T>(value, out, encoding);
+        })
+        , mOperations(&valueOperations<Json, T>)
+    {
+    }
+    template<typename T, typename = std::enable_if_t<IsNumericArray<T>::value>>
+    BasicJsonPair(const std::string& name, std::optional<T>& value, NumericArrayEncoding encoding)
+        : mIsOptional(true)
+        , mAddress(static_cast<void*>(&value))
+        , mName(name)
+        , mToJsonFunction(
+              [encoding](const void* optional) { return templateOptionalNumericArrayToJson<Json, T>(optional, encoding); })
+        , mIsJsonValidFunction(
+              [encoding](const Json& value) { return templateIsNumericArrayValid(value, encoding); })
+        , mHasValueFunction(
+              [](const void* address) { return static_cast<const std::optional<T>*>(address)->has_value(); })
+        , mFromJsonFunction([encoding](const Json& value, void* optional) {
+            return templateOptionalNumericArrayFromJson<Json, T>(value, optional, encoding);
+        })
+        , mOperations(&valueOperations<Json, std::optional<T>>)
+    {
+    }
+
+    /**
+     * @brief Looks for its key in the given JSON object and populates
+     *        the bound variable from the value found.
+     */
+    bool refreshFromJson(const Json& jsonConfig) const
+    {
+        const auto it = jsonConfig.find(mName);
+        if (it == jsonConfig.end())
         {
-            errorMsg = mIsJsonValidFunction(jsonConfig, mName);
-            isValid  = errorMsg.empty();
+            return notProvided();
         }
+        return refreshFromJsonValue(*it);
+    }
+
+    /**
+     * @brief Reports that there is no value for this pair, the bound variable
+     *        is left unchanged.
+     * @return true if the variable is optional
+     */
+    bool notProvided() const
+    {
+        printInvalid("is not provided");
+        return mIsOptional;
+    }
 
-        if (!isValid)
+    /**
+     * @brief Populates the bound variable from the value of this pair,
+     *        i.e. without the key. Null is accepted for optional variables.
+     */
+    bool refreshFromJsonValue(const Json& value) const
+    {
+        bool isValid = true;
+
+        const bool explicitNullOpt = mIsOptional && value.is_null();
+        if (!explicitNullOpt)
         {
-            if (mIsOptional)
-            {
-                std::cout << "Optional field: '" << mName << "': " << errorMsg << std::endl;
-            }
-            else
+            const auto errorMsg = mIsJsonValidFunction(value);
+            isValid             = errorMsg.empty();
+            if (!isValid)
             {
-                std::cout << "Mandatory field: '" << mName << "': " << errorMsg << std::endl;
+                printInvalid(errorMsg);
             }
         }
-        else
+
+        if (isValid)
         {
-            isValid = mFromJsonFunction(jsonConfig, mName, mAddress);
+            isValid = mFromJsonFunction(value, mAddress);
         }
 
         return isValid || mIsOptional;
     }
 
-    nlohmann::json::object_t::value_type toJson() const
+    typename Json::object_t::value_type toJson() const
+    {
+        return {mName, toJsonValue()};
+    }
+
+    /**
+     * @brief The value of this pair, i.e. without the key.
+     *        Must only be called if hasValue() is true.
+     */
+    Json toJsonValue() const
+    {
+        return mToJsonFunction(mAddress);
+    }
+
+    /**
+     * @brief The value of this pair, converting only the selected fields of the
+     *        JsonObjects it holds. Values without JsonObjects are converted whole.
+     *        Must only be called if hasValue() is true.
+     */
+    Json toJsonValue(const FieldProjection& projection) const
     {
-        return mToJsonFunction(mName, mAddress);
+        return mOperations->projectedToJson != nullptr ? mOperations->projectedToJson(mAddress, projection) : toJsonValue();
     }
 
     bool hasValue() const
@@ -93,6 +258,11 @@ public:
         return mHasValueFunction(mAddress);
     }
 
+    bool isOptional() const
+    {
+        return mIsOptional;
+    }
+
     void* getMutableAddress() const
     {
         return mAddress;
@@ -108,16 +278,103 @@ public:
         return mName;
     }
 
+    /**
+     * @return the type of the bound variable, e.g. std::optional<T> for optional fields
+     */
+    const std::type_info& getType() const
+    {
+        return *mOperations->type;
+    }
+
+    /**
+     * @brief Typed access to the bound variable.
+     * @return nullptr if T is not exactly the type of the bound variable
+     */
+    template<typename T>
+    const T* getIf() const
+    {
+        return *mOperations->type == typeid(T) ? static_cast<const T*>(mAddress) : nullptr;
+    }
+
+    template<typename T>
+    T* getMutableIf()
+    {
+        return *mOperations->type == typeid(T) ? static_cast<T*>(mAddress) : nullptr;
+    }
+
+    /**
+     * @return the bound variable as a JsonObject, nullptr if it is not one
+     *         (or is an empty optional)
+     */
+    BasicJsonObject<Json>* getNestedObject() const
+    {
+        return mOperations->nestedObject(mAddress);
+    }
+
+    /**
+     * @return the element selected by an index (sequence containers) or by a
+     *         key (maps) if the bound variable is a container of JsonObjects,
+     *         nullptr otherwise or if there is no such element
+     */
+    BasicJsonObject<Json>* getNestedElement(std::string_view token) const
+    {
+        return mOperations->nestedElement(mAddress, token);
+    }
+
+    /**
+     * @brief Feeds the key and the bound value to the hasher.
+     */
+    void hash(FingerprintHasher& hasher) const
+    {
+        hasher.update(mName);
+        mOperations->hash(hasher, mAddress);
+    }
+
+    /**
+     * @brief Resets the bound variable to the one of defaults, a pair of the same
+     *        key and bound type (see resetValue).
+     */
+    void resetFrom(const BasicJsonPair& defaults) const
+    {
+        mOperations->reset(mAddress, defaults.mAddress);
+    }
+
+    /**
+     * @return true if both pairs have the same key and bound type, and equal values
+     */
+    bool equals(const BasicJsonPair& other) const
+    {
+        return mName == other.mName && *mOperations->type == *other.mOperations->type
+               && mOperations->equals(mAddress, other.mAddress);
+    }
+
 private:
+    void printInvalid(const std::string& errorMsg) const
+    {
+        if (mIsOptional)
+        {
+            std::cout << "Optional field: '" << mName << "': " << errorMsg << std::endl;
+        }
+        else
+        {
+            std::cout << "Mandatory field: '" << mName << "': " << errorMsg << std::endl;
+        }
+    }
+
     bool mIsOptional;
     void* mAddress;
     std::string mName;
-    std::function<nlohmann::json::object_t::value_type(const std::string&, const void*)> mToJsonFunction;
-    std::function<std::string(const nlohmann::json&, const std::string&)> mIsJsonValidFunction;
+    std::function<Json(const void*)> mToJsonFunction;
+    std::function<std::string(const Json&)> mIsJsonValidFunction;
     std::function<bool(const void*)> mHasValueFunction;
-    std::function<bool(const nlohmann::json&, const std::string&, void*)> mFromJsonFunction;
+    std::function<bool(const Json&, void*)> mFromJsonFunction;
+    // Shared by all the pairs bound to the same type
+    const ValueOperations<Json>* mOperations;
 };
 
+using JsonPair        = BasicJsonPair<nlohmann::json>;
+using OrderedJsonPair = BasicJsonPair<nlohmann::ordered_json>;
+
 } // namespace joc
 
 #endif
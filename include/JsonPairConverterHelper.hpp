@@ -1,10 +1,19 @@
 #ifndef JSON_JSONPAIRCONVERTERHELPER_HPP_
 #define JSON_JSONPAIRCONVERTERHELPER_HPP_
 
+#include "JsonFieldProjection.hpp"
+#include "JsonNumericArrayCodec.hpp"
+#include "JsonTimestampCodec.hpp"
+
 #include "nlohmann/json.hpp"
 
 #include <chrono>
+#include <charconv>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <type_traits>
 
 namespace std
@@ -12,28 +21,43 @@ namespace std
 namespace chrono
 {
 
-template<typename Rep, typename Per>
-void to_json(nlohmann::json& j, const duration<Rep, Per>& cpp)
+template<typename BasicJsonType,
+         typename Rep,
+         typename Per,
+         typename = std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value>>
+void to_json(BasicJsonType& j, const duration<Rep, Per>& cpp)
 {
     j = cpp.count();
 }
 
-template<typename _Rep, typename _Per>
-void from_json(const nlohmann::json& j, duration<_Rep, _Per>& cpp)
+template<typename BasicJsonType,
+         typename _Rep,
+         typename _Per,
+         typename = std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value>>
+void from_json(const BasicJsonType& j, duration<_Rep, _Per>& cpp)
 {
-    cpp = std::chrono::duration<_Rep, _Per>(j);
+    cpp = std::chrono::duration<_Rep, _Per>(j.template get<_Rep>());
 }
 
-template<typename _Clock, typename _Dur>
-void to_json(nlohmann::json& j, const time_point<_Clock, _Dur>& cpp)
+template<typename BasicJsonType,
+         typename _Clock,
+         typename _Dur,
+         typename = std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value>>
+void to_json(BasicJsonType& j, const time_point<_Clock, _Dur>& cpp)
 {
-    to_json(j, duration_cast<seconds>(cpp.time_since_epoch()));
+    j = joc::timestampToJson<BasicJsonType>(cpp, joc::TimestampEncodingOf<time_point<_Clock, _Dur>>::value);
 }
 
-template<typename _Clock, typename _Dur>
-void from_json(const nlohmann::json& j, time_point<_Clock, _Dur>& cpp)
+template<typename BasicJsonType,
+         typename _Clock,
+         typename _Dur,
+         typename = std::enable_if_t<nlohmann::detail::is_basic_json<BasicJsonType>::value>>
+void from_json(const BasicJsonType& j, time_point<_Clock, _Dur>& cpp)
 {
-    cpp = std::chrono::time_point<_Clock, _Dur>(seconds(j));
+    if (!joc::timestampFromJson(j, joc::TimestampEncodingOf<time_point<_Clock, _Dur>>::value, cpp))
+    {
+        throw std::invalid_argument("invalid timestamp: " + j.dump());
+    }
 }
 
 } // namespace chrono
@@ -42,116 +66,498 @@ void from_json(const nlohmann::json& j, time_point<_Clock, _Dur>& cpp)
 namespace joc
 {
 
+template<typename Json>
+class BasicJsonObject;
+
+template<typename Json>
+struct ObjectReset;
+
 using SystemClock     = std::chrono::system_clock;
 using SteadyClock     = std::chrono::steady_clock;
 using SystemTimePoint = std::chrono::time_point<SystemClock>;
 using SteadyTimePoint = std::chrono::time_point<SteadyClock>;
 
-template<typename T>
-nlohmann::json::object_t::value_type templateToJson(const std::string& name, const void* value)
+/**
+ * The conversion functions below are templated on the nlohmann::basic_json
+ * specialization (Json) and on the C++ type of the bound variable (T).
+ */
+
+template<typename Json, typename T>
+Json templateToJson(const void* value)
 {
-    return {name, *static_cast<const T*>(value)};
+    return *static_cast<const T*>(value);
 }
 
-template<typename T>
-nlohmann::json::object_t::value_type templateOptionalToJson(const std::string& name, const void* optional)
+template<typename Json, typename T>
+Json templateOptionalToJson(const void* optional)
 {
     const std::optional<T>& optionalType = *static_cast<const std::optional<T>*>(optional);
-    return templateToJson<T>(name, &optionalType.value());
+    return templateToJson<Json, T>(&optionalType.value());
 }
 
-template<typename T>
-nlohmann::json getDummyJsonFromCppVar()
+template<typename Json, typename T>
+Json getDummyJsonFromCppVar()
 {
-    return nlohmann::json(T());
+    return Json(T());
 }
 
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<std::chrono::nanoseconds>()
+template<typename Json, typename T>
+std::string templateIsJsonValid(const Json& value)
 {
-    return nlohmann::json(int64_t());
+    if constexpr (std::is_same_v<T, Json>)
+    {
+        return std::string();
+    }
+    else
+    {
+        // type_name() returns string literals, the expected one is looked up once
+        static const std::string_view expected = getDummyJsonFromCppVar<Json, T>().type_name();
+        if (std::string_view(value.type_name()) != expected)
+        {
+            std::string msg = "is of invalid type, expected: ";
+            msg += expected;
+            msg += " but is: ";
+            msg += value.type_name();
+            return msg;
+        }
+        return std::string();
+    }
 }
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<std::chrono::microseconds>()
+
+/**
+ * @brief Default constructed instance of T, built once, from which values are reset.
+ */
+template<typename T>
+const T& defaultInstance()
 {
-    return nlohmann::json(int64_t());
+    static const T instance{};
+    return instance;
 }
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<std::chrono::milliseconds>()
+
+/**
+ * Sequence containers (std::vector, std::list, std::deque) that are refreshed in
+ * place: they are resized to the JSON array and their elements are reused, so the
+ * buffers and the capacity of the elements are kept. std::vector<bool> and
+ * strings are converted by nlohmann::json. If an element fails to convert, the
+ * field fails and, as for the fields of an object, the container is left with the
+ * size of the JSON array and the elements converted until then.
+ */
+template<typename T, typename = void>
+struct IsResizableSequence : std::false_type
 {
-    return nlohmann::json(int64_t());
-}
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<std::chrono::seconds>()
+};
+template<typename T>
+struct IsResizableSequence<
+    T,
+    std::void_t<typename T::value_type, decltype(std::declval<T&>().resize(std::size_t())), decltype(std::declval<T&>().begin())>>
+    : std::bool_constant<!std::is_same_v<typename T::value_type, bool>
+                         && !std::is_convertible_v<const T&, std::string_view>
+                         && std::is_default_constructible_v<typename T::value_type>>
 {
-    return nlohmann::json(int64_t());
+};
+
+/**
+ * @brief Resets a value to the given defaults while keeping the capacity of its
+ *        strings and containers: they are copy-assigned. JsonObjects are reset field
+ *        by field.
+ */
+template<typename Json, typename T>
+void resetValue(T& value, const T& defaults)
+{
+    if constexpr (std::is_base_of_v<BasicJsonObject<Json>, T>)
+    {
+        ObjectReset<Json>::reset(value, defaults);
+    }
+    else if constexpr (std::is_copy_assignable_v<T>)
+    {
+        value = defaults;
+    }
+    else
+    {
+        value = T();
+    }
 }
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<joc::SystemTimePoint>()
+
+template<typename Json, typename T>
+void templateReset(void* value, const void* defaults)
 {
-    return nlohmann::json(int64_t());
+    resetValue<Json>(*static_cast<T*>(value), *static_cast<const T*>(defaults));
 }
-template<>
-inline nlohmann::json getDummyJsonFromCppVar<joc::SteadyTimePoint>()
+
+template<typename Json, typename T>
+bool templateFromJson(const Json& value, void* out)
 {
-    return nlohmann::json(int64_t());
+    if constexpr (std::is_same_v<T, Json>)
+    {
+        *static_cast<Json*>(out) = value;
+    }
+    else if constexpr (IsTimePoint<T>::value)
+    {
+        // Malformed timestamps fail the field, as with a per field encoding
+        return timestampFromJson(value, TimestampEncodingOf<T>::value, *static_cast<T*>(out));
+    }
+    else if constexpr (IsNumericArray<T>::value)
+    {
+        auto& values = *static_cast<T*>(out);
+        if (!numericArrayFromJson(value, NumericArrayEncoding::Array, values))
+        {
+            // Not an array, or a std::array of another size: nlohmann::json converts or reports the error
+            value.template get_to<T>(values);
+        }
+    }
+    else if constexpr (IsResizableSequence<T>::value)
+    {
+        if (!value.is_array())
+        {
+            // nlohmann::json reports the error
+            value.template get_to<T>(*static_cast<T*>(out));
+            return true;
+        }
+        using Element = typename T::value_type;
+
+        auto& container       = *static_cast<T*>(out);
+        const auto reusedSize = container.size();
+        container.resize(value.size());
+        auto success  = true;
+        std::size_t i = 0;
+        auto element  = container.begin();
+        for (const auto& item : value)
+        {
+            if (i++ < reusedSize)
+            {
+                resetValue<Json>(*element, defaultInstance<Element>());
+            }
+            bool converted = false;
+            if constexpr (std::is_base_of_v<BasicJsonObject<Json>, Element>)
+            {
+                converted = element->refreshFromJson(item);
+            }
+            else
+            {
+                converted = templateFromJson<Json, Element>(item, &*element);
+            }
+            success = success && converted;
+            ++element;
+        }
+        return success;
+    }
+    else
+    {
+        value.template get_to<T>(*static_cast<T*>(out));
+    }
+    return true;
 }
 
-template<typename T>
-std::string templateIsJsonValid(const nlohmann::json& jsonConfig, const std::string& name)
+template<typename Json, typename T>
+bool templateOptionalFromJson(const Json& value, void* optional)
 {
-    if (!jsonConfig.contains(name))
+    std::optional<T>& optionalType = *static_cast<std::optional<T>*>(optional);
+    if (value.is_null())
     {
-        return "is not provided";
+        optionalType = std::nullopt;
+        return true;
     }
-    if (jsonConfig[name].type_name() != getDummyJsonFromCppVar<T>().type_name())
+    if (optionalType.has_value())
+    {
+        resetValue<Json>(*optionalType, defaultInstance<T>());
+    }
+    else
+    {
+        optionalType.emplace();
+    }
+    return templateFromJson<Json, T>(value, &optionalType.value());
+}
+
+/**
+ * Conversion functions for time points whose encoding is chosen per field,
+ * overriding TimestampEncodingOf.
+ */
+template<typename Json, typename TimePoint>
+Json templateTimestampToJson(const void* value, TimestampEncoding encoding)
+{
+    return timestampToJson<Json>(*static_cast<const TimePoint*>(value), encoding);
+}
+
+template<typename Json, typename TimePoint>
+Json templateOptionalTimestampToJson(const void* optional, TimestampEncoding encoding)
+{
+    const std::optional<TimePoint>& optionalType = *static_cast<const std::optional<TimePoint>*>(optional);
+    return templateTimestampToJson<Json, TimePoint>(&optionalType.value(), encoding);
+}
+
+template<typename Json>
+std::string templateIsTimestampValid(const Json& value, TimestampEncoding encoding)
+{
+    if (std::string_view(value.type_name()) != timestampJsonTypeName(encoding))
     {
         std::string msg = "is of invalid type, expected: ";
-        msg += getDummyJsonFromCppVar<T>().type_name();
+        msg += timestampJsonTypeName(encoding);
         msg += " but is: ";
-        msg += jsonConfig[name].type_name();
+        msg += value.type_name();
         return msg;
     }
     return std::string();
 }
 
-template<>
-inline std::string templateIsJsonValid<nlohmann::json>(const nlohmann::json& jsonConfig, const std::string& name)
+template<typename Json, typename TimePoint>
+bool templateTimestampFromJson(const Json& value, void* out, TimestampEncoding encoding)
 {
-    if (!jsonConfig.contains(name))
+    return timestampFromJson(value, encoding, *static_cast<TimePoint*>(out));
+}
+
+template<typename Json, typename TimePoint>
+bool templateOptionalTimestampFromJson(const Json& value, void* optional, TimestampEncoding encoding)
+{
+    std::optional<TimePoint>& optionalType = *static_cast<std::optional<TimePoint>*>(optional);
+    if (value.is_null())
     {
-        return "is not provided";
+        optionalType = std::nullopt;
+        return true;
     }
-    return std::string();
+    TimePoint timePoint;
+    if (!templateTimestampFromJson<Json, TimePoint>(value, &timePoint, encoding))
+    {
+        return false;
+    }
+    optionalType = timePoint;
+    return true;
 }
 
-template<typename T>
-bool templateFromJson(const nlohmann::json& jsonConfig, const std::string& name, void* value)
+/**
+ * Conversion functions for numeric arrays whose encoding is chosen per field.
+ */
+template<typename Json, typename Container>
+Json templateNumericArrayToJson(const void* value, NumericArrayEncoding encoding)
 {
-    jsonConfig[name].get_to<T>(*static_cast<T*>(value));
-    return true;
+    return numericArrayToJson<Json>(*static_cast<const Container*>(value), encoding);
 }
 
-template<>
-inline bool
-templateFromJson<nlohmann::json>(const nlohmann::json& jsonConfig, const std::string& name, void* value)
+template<typename Json, typename Container>
+Json templateOptionalNumericArrayToJson(const void* optional, NumericArrayEncoding encoding)
 {
-    *static_cast<nlohmann::json*>(value) = jsonConfig[name];
-    return true;
+    const std::optional<Container>& optionalType = *static_cast<const std::optional<Container>*>(optional);
+    return templateNumericArrayToJson<Json, Container>(&optionalType.value(), encoding);
 }
 
-template<typename T>
-bool templateOptionalFromJson(const nlohmann::json& jsonConfig, const std::string& name, void* optional)
+template<typename Json>
+std::string templateIsNumericArrayValid(const Json& value, NumericArrayEncoding encoding)
 {
-    std::optional<T>& optionalType = *static_cast<std::optional<T>*>(optional);
-    optionalType                   = T();
-    if (jsonConfig[name].is_null())
+    if (std::string_view(value.type_name()) != numericArrayJsonTypeName(encoding))
+    {
+        std::string msg = "is of invalid type, expected: ";
+        msg += numericArrayJsonTypeName(encoding);
+        msg += " but is: ";
+        msg += value.type_name();
+        return msg;
+    }
+    return std::string();
+}
+
+template<typename Json, typename Container>
+bool templateNumericArrayFromJson(const Json& value, void* out, NumericArrayEncoding encoding)
+{
+    return numericArrayFromJson(value, encoding, *static_cast<Container*>(out));
+}
+
+template<typename Json, typename Container>
+bool templateOptionalNumericArrayFromJson(const Json& value, void* optional, NumericArrayEncoding encoding)
+{
+    std::optional<Container>& optionalType = *static_cast<std::optional<Container>*>(optional);
+    if (value.is_null())
     {
         optionalType = std::nullopt;
         return true;
     }
-    return templateFromJson<T>(jsonConfig, name, &optionalType.value());
+    if (!optionalType.has_value())
+    {
+        optionalType.emplace();
+    }
+    return templateNumericArrayFromJson<Json, Container>(value, &optionalType.value(), encoding);
 }
+
+/**
+ * Access to the JsonObjects nested in a bound value, used to resolve JSON Pointers.
+ *  - object():  the value itself, if it is a JsonObject (or an engaged optional of one)
+ *  - element(): the element of a container of JsonObjects, selected by index or by key
+ */
+template<typename Json, typename T, typename = void>
+struct NestedObjectAccess
+{
+    static BasicJsonObject<Json>* object(void*)
+    {
+        return nullptr;
+    }
+    static BasicJsonObject<Json>* element(void*, std::string_view)
+    {
+        return nullptr;
+    }
+};
+
+template<typename Json, typename T>
+struct NestedObjectAccess<Json, T, std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, T>>>
+{
+    static BasicJsonObject<Json>* object(void* value)
+    {
+        return static_cast<T*>(value);
+    }
+    static BasicJsonObject<Json>* element(void*, std::string_view)
+    {
+        return nullptr;
+    }
+};
+
+template<typename Json, typename T>
+struct NestedObjectAccess<Json, std::optional<T>>
+{
+    static BasicJsonObject<Json>* object(void* value)
+    {
+        auto& optional = *static_cast<std::optional<T>*>(value);
+        return optional.has_value() ? NestedObjectAccess<Json, T>::object(&optional.value()) : nullptr;
+    }
+    static BasicJsonObject<Json>* element(void* value, std::string_view token)
+    {
+        auto& optional = *static_cast<std::optional<T>*>(value);
+        return optional.has_value() ? NestedObjectAccess<Json, T>::element(&optional.value(), token) : nullptr;
+    }
+};
+
+// Sequence containers (std::vector, std::list, ...) of JsonObjects, indexed by position
+template<typename Json, typename T>
+struct NestedObjectAccess<
+    Json,
+    T,
+    std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, typename T::value_type>
+                     && std::is_same_v<decltype(std::declval<T&>().size()), typename T::size_type>>>
+{
+    static BasicJsonObject<Json>* object(void*)
+    {
+        return nullptr;
+    }
+    static BasicJsonObject<Json>* element(void* value, std::string_view token)
+    {
+        auto& container = *static_cast<T*>(value);
+        std::size_t index{0};
+        const auto* end = token.data() + token.size();
+        if (token.empty() || std::from_chars(token.data(), end, index).ptr != end || index >= container.size())
+        {
+            return nullptr;
+        }
+        return &*std::next(container.begin(), static_cast<std::ptrdiff_t>(index));
+    }
+};
+
+template<typename T, typename = void>
+struct HasTransparentCompare : std::false_type
+{
+};
+template<typename T>
+struct HasTransparentCompare<T, std::void_t<typename T::key_compare::is_transparent>> : std::true_type
+{
+};
+
+// Maps of JsonObjects with string keys, indexed by key
+template<typename Json, typename T>
+struct NestedObjectAccess<Json,
+                          T,
+                          std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, typename T::mapped_type>
+                                           && std::is_same_v<typename T::key_type, std::string>>>
+{
+    static BasicJsonObject<Json>* object(void*)
+    {
+        return nullptr;
+    }
+    static BasicJsonObject<Json>* element(void* value, std::string_view token)
+    {
+        auto& container = *static_cast<T*>(value);
+        if constexpr (HasTransparentCompare<T>::value)
+        {
+            const auto it = container.find(token);
+            return it == container.end() ? nullptr : &it->second;
+        }
+        else
+        {
+            // Maps that only look up std::string keys: the key buffer of the thread is reused
+            thread_local std::string key;
+            key.assign(token.data(), token.size());
+            const auto it = container.find(key);
+            return it == container.end() ? nullptr : &it->second;
+        }
+    }
+};
+
+/**
+ * Conversion of a bound value with a FieldProjection, for the values that hold
+ * JsonObjects: the projection applies to each of them. Other values are converted
+ * whole, their function is nullptr.
+ */
+template<typename Json>
+using ProjectedToJsonFunction = Json (*)(const void*, const FieldProjection&);
+
+template<typename Json, typename T, typename = void>
+struct ProjectedConversion
+{
+    static constexpr ProjectedToJsonFunction<Json> function = nullptr;
+};
+
+template<typename Json, typename T>
+struct ProjectedConversion<Json, T, std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, T>>>
+{
+    static Json toJson(const void* value, const FieldProjection& projection)
+    {
+        return static_cast<const T*>(value)->toJson(projection);
+    }
+    static constexpr ProjectedToJsonFunction<Json> function = toJson;
+};
+
+template<typename Json, typename T>
+struct ProjectedConversion<Json, std::optional<T>, std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, T>>>
+{
+    // Only called for engaged optionals, as toJsonValue
+    static Json toJson(const void* value, const FieldProjection& projection)
+    {
+        return static_cast<const std::optional<T>*>(value)->value().toJson(projection);
+    }
+    static constexpr ProjectedToJsonFunction<Json> function = toJson;
+};
+
+// Sequence containers of JsonObjects
+template<typename Json, typename T>
+struct ProjectedConversion<
+    Json,
+    T,
+    std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, typename T::value_type>
+                     && std::is_same_v<decltype(std::declval<T&>().size()), typename T::size_type>>>
+{
+    static Json toJson(const void* value, const FieldProjection& projection)
+    {
+        auto array = Json::array();
+        for (const auto& element : *static_cast<const T*>(value))
+        {
+            array.push_back(element.toJson(projection));
+        }
+        return array;
+    }
+    static constexpr ProjectedToJsonFunction<Json> function = toJson;
+};
+
+// Maps of JsonObjects with string keys
+template<typename Json, typename T>
+struct ProjectedConversion<Json,
+                           T,
+                           std::enable_if_t<std::is_base_of_v<BasicJsonObject<Json>, typename T::mapped_type>
+                                            && std::is_same_v<typename T::key_type, std::string>>>
+{
+    static Json toJson(const void* value, const FieldProjection& projection)
+    {
+        auto object = Json::object();
+        for (const auto& element : *static_cast<const T*>(value))
+        {
+            object[element.first] = element.second.toJson(projection);
+        }
+        return object;
+    }
+    static constexpr ProjectedToJsonFunction<Json> function = toJson;
+};
 } // namespace json
 
 #endif
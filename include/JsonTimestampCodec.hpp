@@ -0,0 +1,177 @@
+#ifndef JSON_JSONTIMESTAMPCODEC_HPP_
+#define JSON_JSONTIMESTAMPCODEC_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace joc
+{
+
+/**
+ * @brief JSON representation of a std::chrono::time_point.
+ *
+ *        - EpochSeconds/Milliseconds/Microseconds/Nanoseconds: integer count
+ *          since the clock epoch, truncated towards zero to the given unit.
+ *        - Iso8601: RFC 3339 UTC string, e.g. "2021-03-04T05:06:07.123Z".
+ *          The fraction is written in groups of 3 digits and only as long
+ *          as needed, it is omitted for whole seconds.
+ */
+enum class TimestampEncoding
+{
+    EpochSeconds,
+    EpochMilliseconds,
+    EpochMicroseconds,
+    EpochNanoseconds,
+    Iso8601
+};
+
+/**
+ * @brief Per type selection of the timestamp encoding, used by the to_json and
+ *        from_json overloads of std::chrono::time_point. The default keeps the
+ *        historical whole seconds representation. To change it, specialize it
+ *        after including JsonObjectConverter.hpp (joc headers only use it from
+ *        templates instantiated by the conversions of that type), e.g.:
+ *
+ *        template<>
+ *        struct joc::TimestampEncodingOf<joc::SystemTimePoint>
+ *        {
+ *            static constexpr joc::TimestampEncoding value = joc::TimestampEncoding::Iso8601;
+ *        };
+ *
+ *        The specialization must be declared before the first conversion of that
+ *        type in each translation unit, and be the same in all the translation
+ *        units of a program (one-definition rule): put it in a header included
+ *        wherever the type is converted. A program where some translation units
+ *        see it and others do not is ill-formed, no diagnostic required.
+ *
+ *        A single field can override it by passing the encoding to JsonPair.
+ */
+template<typename TimePoint>
+struct TimestampEncodingOf
+{
+    static constexpr TimestampEncoding value = TimestampEncoding::EpochSeconds;
+};
+
+template<typename T>
+struct IsTimePoint : std::false_type
+{
+};
+template<typename Clock, typename Dur>
+struct IsTimePoint<std::chrono::time_point<Clock, Dur>> : std::true_type
+{
+};
+
+/// Longest output of formatIso8601: "YYYY-MM-DDTHH:MM:SS.nnnnnnnnnZ"
+constexpr std::size_t kIso8601MaxLength = 30;
+
+/**
+ * @brief Writes sinceEpoch as an RFC 3339 UTC string, without allocating and
+ *        independently of the locale. The date part is cached per thread, so
+ *        consecutive timestamps of the same day only format the time of day.
+ *
+ * @param sinceEpoch  time since 1970-01-01T00:00:00Z
+ * @param out         buffer of at least kIso8601MaxLength characters, not null-terminated
+ * @return number of characters written
+ */
+std::size_t formatIso8601(std::chrono::nanoseconds sinceEpoch, char* out);
+
+/**
+ * @brief Parses an RFC 3339 string ("YYYY-MM-DDTHH:MM:SS[.fraction](Z|+HH:MM|-HH:MM)").
+ *        Fraction digits beyond nanoseconds are truncated. The last parsed date
+ *        is cached per thread, like in formatIso8601.
+ *
+ * @return false if the text is malformed or out of the nanoseconds range
+ */
+bool parseIso8601(std::string_view text, std::chrono::nanoseconds& sinceEpoch);
+
+/**
+ * @brief JSON type name produced by a given encoding, as in nlohmann::json::type_name().
+ */
+inline const char* timestampJsonTypeName(TimestampEncoding encoding)
+{
+    return encoding == TimestampEncoding::Iso8601 ? "string" : "number";
+}
+
+template<typename Json = nlohmann::json, typename Clock, typename Dur>
+Json timestampToJson(const std::chrono::time_point<Clock, Dur>& timePoint, TimestampEncoding encoding)
+{
+    using namespace std::chrono;
+
+    const auto sinceEpoch = timePoint.time_since_epoch();
+    switch (encoding)
+    {
+    case TimestampEncoding::EpochMilliseconds:
+        return duration_cast<milliseconds>(sinceEpoch).count();
+    case TimestampEncoding::EpochMicroseconds:
+        return duration_cast<microseconds>(sinceEpoch).count();
+    case TimestampEncoding::EpochNanoseconds:
+        return duration_cast<nanoseconds>(sinceEpoch).count();
+    case TimestampEncoding::Iso8601:
+    {
+        char buffer[kIso8601MaxLength];
+        const auto length = formatIso8601(duration_cast<nanoseconds>(sinceEpoch), buffer);
+        return typename Json::string_t(buffer, length);
+    }
+    case TimestampEncoding::EpochSeconds:
+    default:
+        return duration_cast<seconds>(sinceEpoch).count();
+    }
+}
+
+/**
+ * @return false if the JSON value does not match the encoding or cannot be parsed
+ */
+template<typename Json, typename Clock, typename Dur>
+bool timestampFromJson(const Json& j, TimestampEncoding encoding, std::chrono::time_point<Clock, Dur>& timePoint)
+{
+    using namespace std::chrono;
+    using TimePoint = time_point<Clock, Dur>;
+
+    if (encoding == TimestampEncoding::Iso8601)
+    {
+        if (!j.is_string())
+        {
+            return false;
+        }
+        const auto& text = j.template get_ref<const typename Json::string_t&>();
+        nanoseconds sinceEpoch;
+        if (!parseIso8601(std::string_view(text.data(), text.size()), sinceEpoch))
+        {
+            return false;
+        }
+        timePoint = TimePoint(duration_cast<Dur>(sinceEpoch));
+        return true;
+    }
+
+    if (!j.is_number())
+    {
+        return false;
+    }
+    const auto count = j.template get<std::int64_t>();
+    switch (encoding)
+    {
+    case TimestampEncoding::EpochMilliseconds:
+        timePoint = TimePoint(duration_cast<Dur>(milliseconds(count)));
+        break;
+    case TimestampEncoding::EpochMicroseconds:
+        timePoint = TimePoint(duration_cast<Dur>(microseconds(count)));
+        break;
+    case TimestampEncoding::EpochNanoseconds:
+        timePoint = TimePoint(duration_cast<Dur>(nanoseconds(count)));
+        break;
+    default:
+        timePoint = TimePoint(duration_cast<Dur>(seconds(count)));
+        break;
+    }
+    return true;
+}
+
+} // namespace joc
+
+#endif
@@ -0,0 +1,155 @@
+#include "JsonFieldProjection.hpp"
+
+namespace joc
+{
+
+namespace
+{
+std::string_view trim(std::string_view text)
+{
+    const auto begin = text.find_first_not_of(" \t");
+    if (begin == std::string_view::npos)
+    {
+        return std::string_view();
+    }
+    const auto end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+} // namespace
+
+FieldProjection::FieldProjection(std::initializer_list<std::string_view> paths)
+{
+    for (const auto path : paths)
+    {
+        add(path);
+    }
+}
+
+FieldProjection FieldProjection::parse(std::string_view fields)
+{
+    FieldProjection projection;
+    while (!fields.empty())
+    {
+        const auto separator = fields.find(',');
+        projection.add(trim(fields.substr(0, separator)));
+        if (separator == std::string_view::npos)
+        {
+            break;
+        }
+        fields.remove_prefix(separator + 1);
+    }
+    return projection;
+}
+
+void FieldProjection::add(std::string_view path)
+{
+    mPositions.clear();
+
+    if (!path.empty() && path.front() == '/')
+    {
+        path.remove_prefix(1);
+    }
+    if (path.empty())
+    {
+        return;
+    }
+
+    const auto separator = path.find('/');
+    const auto key       = path.substr(0, separator);
+    const auto subPath   = separator == std::string_view::npos ? std::string_view() : path.substr(separator + 1);
+
+    Field* field = nullptr;
+    for (auto& f : mFields)
+    {
+        if (f.key == key)
+        {
+            field = &f;
+            break;
+        }
+    }
+    if (field == nullptr)
+    {
+        mFields.push_back(Field{std::string(key), subPath.empty(), FieldProjection()});
+        field = &mFields.back();
+    }
+    else if (subPath.empty())
+    {
+        field->whole  = true;
+        field->nested = FieldProjection();
+    }
+    else if (field->whole)
+    {
+        // Already selected whole
+        return;
+    }
+
+    if (!subPath.empty())
+    {
+        field->nested.add(subPath);
+    }
+}
+
+const std::vector<FieldProjection::Field>& FieldProjection::fields() const
+{
+    return mFields;
+}
+
+const FieldProjection::Field* FieldProjection::find(std::string_view key) const
+{
+    for (const auto& field : mFields)
+    {
+        if (field.key == key)
+        {
+            return &field;
+        }
+    }
+    return nullptr;
+}
+
+bool FieldProjection::empty() const
+{
+    return mFields.empty();
+}
+
+const std::vector<std::size_t>& FieldProjection::positions(const void* schema, Resolver resolve) const
+{
+    const auto* last = mPositions.last.load(std::memory_order_acquire);
+    if (last != nullptr && last->schema == schema)
+    {
+        return last->positions;
+    }
+
+    std::lock_guard<std::mutex> lk(mPositions.mutex);
+    const PositionCache::Entry* entry = nullptr;
+    for (const auto& e : mPositions.entries)
+    {
+        if (e->schema == schema)
+        {
+            entry = e.get();
+            break;
+        }
+    }
+    if (entry == nullptr)
+    {
+        auto resolved    = std::make_unique<PositionCache::Entry>();
+        resolved->schema = schema;
+        resolved->positions.reserve(mFields.size());
+        for (const auto& field : mFields)
+        {
+            resolved->positions.push_back(resolve(schema, field.key));
+        }
+        entry = resolved.get();
+        mPositions.entries.push_back(std::move(resolved));
+    }
+    mPositions.last.store(entry, std::memory_order_release);
+    return entry->positions;
+}
+
+void FieldProjection::PositionCache::clear()
+{
+    std::lock_guard<std::mutex> lk(mutex);
+    last.store(nullptr, std::memory_order_relaxed);
+    entries.clear();
+}
+
+} // namespace joc
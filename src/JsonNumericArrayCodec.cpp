@@ -0,0 +1,134 @@
+#include "JsonNumericArrayCodec.hpp"
+
+#include <array>
+
+namespace joc
+{
+
+namespace
+{
+
+constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr std::uint8_t INVALID = 0xFF;
+
+constexpr std::array<std::uint8_t, 256> makeDecodingTable()
+{
+    std::array<std::uint8_t, 256> table{};
+    for (auto& entry : table)
+    {
+        entry = INVALID;
+    }
+    for (std::uint8_t i = 0; i < 64; ++i)
+    {
+        table[static_cast<unsigned char>(ALPHABET[i])] = i;
+    }
+    return table;
+}
+
+constexpr auto DECODING_TABLE = makeDecodingTable();
+
+} // namespace
+
+std::size_t base64DecodedLength(std::string_view text)
+{
+    if (text.size() % 4 != 0)
+    {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    std::size_t padding = 0;
+    if (!text.empty() && text.back() == '=')
+    {
+        padding = text[text.size() - 2] == '=' ? 2 : 1;
+    }
+    return text.size() / 4 * 3 - padding;
+}
+
+void encodeBase64(const void* data, std::size_t size, char* out)
+{
+    const auto* in = static_cast<const unsigned char*>(data);
+    for (; size >= 3; in += 3, size -= 3)
+    {
+        const std::uint32_t group = (std::uint32_t(in[0]) << 16) | (std::uint32_t(in[1]) << 8) | in[2];
+        *out++                    = ALPHABET[(group >> 18) & 0x3F];
+        *out++                    = ALPHABET[(group >> 12) & 0x3F];
+        *out++                    = ALPHABET[(group >> 6) & 0x3F];
+        *out++                    = ALPHABET[group & 0x3F];
+    }
+    if (size > 0)
+    {
+        const std::uint32_t group = (std::uint32_t(in[0]) << 16) | (size == 2 ? std::uint32_t(in[1]) << 8 : 0);
+        *out++                    = ALPHABET[(group >> 18) & 0x3F];
+        *out++                    = ALPHABET[(group >> 12) & 0x3F];
+        *out++                    = size == 2 ? ALPHABET[(group >> 6) & 0x3F] : '=';
+        *out++                    = '=';
+    }
+}
+
+bool isBase64(std::string_view text)
+{
+    const auto length = base64DecodedLength(text);
+    if (length == std::numeric_limits<std::size_t>::max())
+    {
+        return false;
+    }
+    // The padding characters are not decoded
+    const std::size_t characters = text.size() - (text.size() / 4 * 3 - length);
+    for (std::size_t i = 0; i < characters; ++i)
+    {
+        if (DECODING_TABLE[static_cast<unsigned char>(text[i])] == INVALID)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool decodeBase64(std::string_view text, void* out)
+{
+    const auto length = base64DecodedLength(text);
+    if (length == std::numeric_limits<std::size_t>::max())
+    {
+        return false;
+    }
+    auto* bytes = static_cast<unsigned char*>(out);
+    const auto* in = reinterpret_cast<const unsigned char*>(text.data());
+
+    // Full groups, the last one is handled separately if padded
+    const std::size_t fullGroups = length / 3;
+    for (std::size_t i = 0; i < fullGroups; ++i, in += 4)
+    {
+        const auto a = DECODING_TABLE[in[0]];
+        const auto b = DECODING_TABLE[in[1]];
+        const auto c = DECODING_TABLE[in[2]];
+        const auto d = DECODING_TABLE[in[3]];
+        if ((a | b | c | d) == INVALID)
+        {
+            return false;
+        }
+        const std::uint32_t group = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6) | d;
+        *bytes++                  = static_cast<unsigned char>(group >> 16);
+        *bytes++                  = static_cast<unsigned char>(group >> 8);
+        *bytes++                  = static_cast<unsigned char>(group);
+    }
+
+    const std::size_t remaining = length % 3;
+    if (remaining > 0)
+    {
+        const auto a = DECODING_TABLE[in[0]];
+        const auto b = DECODING_TABLE[in[1]];
+        const auto c = remaining == 2 ? DECODING_TABLE[in[2]] : std::uint8_t(0);
+        if ((a | b | c) == INVALID)
+        {
+            return false;
+        }
+        const std::uint32_t group = (std::uint32_t(a) << 18) | (std::uint32_t(b) << 12) | (std::uint32_t(c) << 6);
+        *bytes++                  = static_cast<unsigned char>(group >> 16);
+        if (remaining == 2)
+        {
+            *bytes++ = static_cast<unsigned char>(group >> 8);
+        }
+    }
+    return true;
+}
+
+} // namespace joc
@@ -0,0 +1,268 @@
+#include "JsonTimestampCodec.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace joc
+{
+
+namespace
+{
+
+constexpr std::int64_t NANOS_PER_SECOND = 1000000000;
+constexpr std::int64_t SECONDS_PER_DAY  = 86400;
+constexpr std::int64_t NANOS_PER_DAY    = NANOS_PER_SECOND * SECONDS_PER_DAY;
+constexpr std::size_t DATE_LENGTH       = 10; // "YYYY-MM-DD"
+
+// Civil calendar conversions from http://howardhinnant.github.io/date_algorithms.html
+std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const auto yoe         = static_cast<unsigned>(y - era * 400);
+    const unsigned doy     = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe     = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civilFromDays(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const auto doe         = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe     = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy     = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp      = (5 * doy + 2) / 153;
+    d                      = doy - (153 * mp + 2) / 5 + 1;
+    m                      = mp < 10 ? mp + 3 : mp - 9;
+    y                      = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+bool isLeapYear(std::int64_t y)
+{
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+unsigned daysInMonth(std::int64_t y, unsigned m)
+{
+    static constexpr unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (m == 2 && isLeapYear(y)) ? 29 : days[m - 1];
+}
+
+inline void writeDigits2(char* out, unsigned value)
+{
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+}
+
+inline void writeDigits(char* out, std::uint32_t value, int count)
+{
+    for (int i = count - 1; i >= 0; --i)
+    {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+inline bool readDigits(const char* in, int count, unsigned& value)
+{
+    value = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const auto digit = static_cast<unsigned>(in[i] - '0');
+        if (digit > 9)
+        {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+struct FormatDateCache
+{
+    std::int64_t days{std::numeric_limits<std::int64_t>::min()};
+    char text[DATE_LENGTH];
+};
+
+struct ParseDateCache
+{
+    char text[DATE_LENGTH]{}; // never matches a valid date until filled
+    std::int64_t days{0};
+};
+
+thread_local FormatDateCache formatCache;
+thread_local ParseDateCache parseCache;
+
+bool parseDate(const char* in, std::int64_t& days)
+{
+    if (std::memcmp(in, parseCache.text, DATE_LENGTH) == 0)
+    {
+        days = parseCache.days;
+        return true;
+    }
+
+    unsigned y, m, d;
+    if (!readDigits(in, 4, y) || in[4] != '-' || !readDigits(in + 5, 2, m) || in[7] != '-'
+        || !readDigits(in + 8, 2, d))
+    {
+        return false;
+    }
+    if (m < 1 || m > 12 || d < 1 || d > daysInMonth(y, m))
+    {
+        return false;
+    }
+
+    days = daysFromCivil(y, m, d);
+    std::memcpy(parseCache.text, in, DATE_LENGTH);
+    parseCache.days = days;
+    return true;
+}
+
+} // namespace
+
+std::size_t formatIso8601(std::chrono::nanoseconds sinceEpoch, char* out)
+{
+    const std::int64_t ns = sinceEpoch.count();
+    std::int64_t days     = ns / NANOS_PER_DAY;
+    std::int64_t nsOfDay  = ns % NANOS_PER_DAY;
+    if (nsOfDay < 0)
+    {
+        nsOfDay += NANOS_PER_DAY;
+        --days;
+    }
+
+    if (days != formatCache.days)
+    {
+        std::int64_t y;
+        unsigned m, d;
+        civilFromDays(days, y, m, d);
+        writeDigits(formatCache.text, static_cast<std::uint32_t>(y), 4);
+        formatCache.text[4] = '-';
+        writeDigits2(formatCache.text + 5, m);
+        formatCache.text[7] = '-';
+        writeDigits2(formatCache.text + 8, d);
+        formatCache.days = days;
+    }
+    std::memcpy(out, formatCache.text, DATE_LENGTH);
+
+    const auto secondsOfDay = static_cast<unsigned>(nsOfDay / NANOS_PER_SECOND);
+    auto fraction           = static_cast<std::uint32_t>(nsOfDay % NANOS_PER_SECOND);
+
+    char* it = out + DATE_LENGTH;
+    it[0]    = 'T';
+    writeDigits2(it + 1, secondsOfDay / 3600);
+    it[3] = ':';
+    writeDigits2(it + 4, secondsOfDay / 60 % 60);
+    it[6] = ':';
+    writeDigits2(it + 7, secondsOfDay % 60);
+    it += 9;
+
+    if (fraction != 0)
+    {
+        int digits = 9;
+        while (fraction % 1000 == 0)
+        {
+            fraction /= 1000;
+            digits -= 3;
+        }
+        *it++ = '.';
+        writeDigits(it, fraction, digits);
+        it += digits;
+    }
+    *it++ = 'Z';
+    return static_cast<std::size_t>(it - out);
+}
+
+bool parseIso8601(std::string_view text, std::chrono::nanoseconds& sinceEpoch)
+{
+    // Shortest valid input: "YYYY-MM-DDTHH:MM:SSZ"
+    if (text.size() < DATE_LENGTH + 10)
+    {
+        return false;
+    }
+    const char* it  = text.data();
+    const char* end = it + text.size();
+
+    std::int64_t days;
+    if (!parseDate(it, days))
+    {
+        return false;
+    }
+    it += DATE_LENGTH;
+
+    unsigned hh, mm, ss;
+    if ((*it != 'T' && *it != 't' && *it != ' ') || !readDigits(it + 1, 2, hh) || it[3] != ':'
+        || !readDigits(it + 4, 2, mm) || it[6] != ':' || !readDigits(it + 7, 2, ss))
+    {
+        return false;
+    }
+    // 60 is a leap second, which is folded into the next minute
+    if (hh > 23 || mm > 59 || ss > 60)
+    {
+        return false;
+    }
+    it += 9;
+
+    std::int64_t fraction = 0;
+    if (it != end && *it == '.')
+    {
+        ++it;
+        int digits = 0;
+        for (; it != end && static_cast<unsigned>(*it - '0') <= 9; ++it, ++digits)
+        {
+            if (digits < 9)
+            {
+                fraction = fraction * 10 + (*it - '0');
+            }
+        }
+        if (digits == 0)
+        {
+            return false;
+        }
+        for (; digits < 9; ++digits)
+        {
+            fraction *= 10;
+        }
+    }
+
+    std::int64_t offsetSeconds = 0;
+    if (it == end)
+    {
+        return false;
+    }
+    if (*it == 'Z' || *it == 'z')
+    {
+        ++it;
+    }
+    else if (*it == '+' || *it == '-')
+    {
+        unsigned offH, offM;
+        if (end - it < 6 || !readDigits(it + 1, 2, offH) || it[3] != ':' || !readDigits(it + 4, 2, offM)
+            || offH > 23 || offM > 59)
+        {
+            return false;
+        }
+        offsetSeconds = static_cast<std::int64_t>(offH * 3600 + offM * 60) * (*it == '-' ? -1 : 1);
+        it += 6;
+    }
+    else
+    {
+        return false;
+    }
+    if (it != end)
+    {
+        return false;
+    }
+
+    const std::int64_t seconds = days * SECONDS_PER_DAY + hh * 3600 + mm * 60 + ss - offsetSeconds;
+    constexpr std::int64_t maxSeconds = std::numeric_limits<std::int64_t>::max() / NANOS_PER_SECOND;
+    if (seconds >= maxSeconds || seconds <= -maxSeconds)
+    {
+        return false;
+    }
+    sinceEpoch = std::chrono::nanoseconds(seconds * NANOS_PER_SECOND + fraction);
+    return true;
+}
+
+} // namespace joc
@@ -0,0 +1,114 @@
+/**
+ * Compares the conversions of the same schema with a std::map-backed JSON type
+ * (JsonObject, nlohmann::json) and a vector-backed one (OrderedJsonObject,
+ * nlohmann::ordered_json).
+ *
+ * Usage: jsonbackend_bench [iterations]
+ */
+#include "JsonObjectConverter.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace joc;
+
+namespace
+{
+template<typename Base>
+struct Reading : public Base
+{
+    Reading()
+        : Base({
+            {"sensor", sensor},
+            {"unit", unit},
+            {"value", value},
+            {"minimum", minimum},
+            {"maximum", maximum},
+            {"valid", valid},
+            {"sequence", sequence},
+            {"note", note},
+        }){};
+
+    std::string sensor{"temperature-0"};
+    std::string unit{"celsius"};
+    double value{21.5};
+    double minimum{-40.0};
+    double maximum{85.0};
+    bool valid{true};
+    int sequence{0};
+    std::optional<std::string> note{"calibrated"};
+};
+
+template<typename Base>
+struct Batch : public Base
+{
+    Batch()
+        : Base({{"device", device}, {"readings", readings}}){};
+
+    std::string device{"device-0"};
+    std::vector<Reading<Base>> readings;
+};
+
+// Keeps the compiler from discarding the benchmarked results
+volatile std::size_t sink = 0;
+
+template<typename Function>
+double nanosecondsPerIteration(std::size_t iterations, Function&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+template<typename Base>
+void run(const char* name, std::size_t iterations, std::size_t readings)
+{
+    using Json = typename Base::JsonType;
+
+    Batch<Base> batch;
+    batch.readings.resize(readings);
+    for (std::size_t i = 0; i < readings; ++i)
+    {
+        batch.readings[i].sequence = static_cast<int>(i);
+    }
+    const auto text = batch.toJson().dump();
+
+    const auto toJson = nanosecondsPerIteration(iterations, [&batch]() { sink += batch.toJson().size(); });
+    const auto dump   = nanosecondsPerIteration(iterations, [&batch]() { sink += batch.toJson().dump().size(); });
+    const auto parse  = nanosecondsPerIteration(iterations, [&text]() { sink += Json::parse(text).size(); });
+    Batch<Base> decoded;
+    const auto refresh = nanosecondsPerIteration(iterations, [&text, &decoded]() {
+        sink += decoded.refreshFromJson(Json::parse(text)) ? 1 : 0;
+    });
+
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << toJson << std::setw(12) << dump << std::setw(12) << parse << std::setw(16)
+              << refresh << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+
+    for (const std::size_t readings : {1, 10, 100})
+    {
+        std::cout << "Batch of " << readings << " readings, ns per iteration (" << iterations << " iterations)"
+                  << std::endl;
+        std::cout << std::left << std::setw(20) << "" << std::right << std::setw(12) << "toJson" << std::setw(12)
+                  << "dump" << std::setw(12) << "parse" << std::setw(16) << "parse+refresh" << std::endl;
+        run<JsonObject>("JsonObject", iterations, readings);
+        run<OrderedJsonObject>("OrderedJsonObject", iterations, readings);
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * Compares the conversions of a field of double samples: per element (std::list),
+ * in bulk (std::vector) and packed in base64 (NumericArrayEncoding::Base64).
+ *
+ * Usage: numericarray_bench [iterations]
+ */
+#include "JsonObjectConverter.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <vector>
+
+using namespace joc;
+
+namespace
+{
+struct ListSamples : public JsonObject
+{
+    ListSamples()
+        : JsonObject({{"samples", samples}}){};
+
+    std::list<double> samples;
+};
+
+struct VectorSamples : public JsonObject
+{
+    VectorSamples()
+        : JsonObject({{"samples", samples}}){};
+
+    std::vector<double> samples;
+};
+
+struct PackedSamples : public JsonObject
+{
+    PackedSamples()
+        : JsonObject({{"samples", samples, NumericArrayEncoding::Base64}}){};
+
+    std::vector<double> samples;
+};
+
+// Keeps the compiler from discarding the benchmarked results
+volatile std::size_t sink = 0;
+
+template<typename Function>
+double nanosecondsPerIteration(std::size_t iterations, Function&& function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+template<typename Samples>
+void run(const char* name, std::size_t iterations, std::size_t count)
+{
+    Samples samples;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        samples.samples.push_back(std::sin(static_cast<double>(i) * 0.001) * 1000.0);
+    }
+    const auto json = samples.toJson();
+    const auto text = json.dump();
+
+    const auto dump = nanosecondsPerIteration(iterations, [&samples]() { sink += samples.toJson().dump().size(); });
+    Samples decoded;
+    const auto refresh = nanosecondsPerIteration(iterations, [&json, &decoded]() {
+        sink += decoded.refreshFromJson(json) ? 1 : 0;
+    });
+    const auto parseRefresh = nanosecondsPerIteration(iterations, [&text, &decoded]() {
+        sink += decoded.refreshFromJson(nlohmann::json::parse(text)) ? 1 : 0;
+    });
+
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(14) << dump << std::setw(12) << refresh << std::setw(16) << parseRefresh << std::setw(12)
+              << text.size() << std::endl;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+
+    for (const std::size_t count : {100, 10000})
+    {
+        std::cout << count << " samples, ns per iteration (" << iterations << " iterations)" << std::endl;
+        std::cout << std::left << std::setw(20) << "" << std::right << std::setw(14) << "toJson+dump" << std::setw(12)
+                  << "refresh" << std::setw(16) << "parse+refresh" << std::setw(12) << "bytes" << std::endl;
+        run<ListSamples>("std::list", iterations, count);
+        run<VectorSamples>("std::vector", iterations, count);
+        run<PackedSamples>("std::vector base64", iterations, count);
+        std::cout << std::endl;
+    }
+    return 0;
+}
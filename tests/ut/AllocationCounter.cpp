@@ -0,0 +1,161 @@
+#include "AllocationCounter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+thread_local bool counting{false};
+thread_local joc::test::AllocationStats threadStats;
+
+void* countedAllocate(std::size_t size, std::size_t alignment)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+    void* ptr = nullptr;
+    if (alignment > alignof(std::max_align_t))
+    {
+        // aligned_alloc requires a size multiple of the alignment
+        ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    else
+    {
+        ptr = std::malloc(size);
+    }
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    if (counting)
+    {
+        ++threadStats.allocations;
+        threadStats.bytes += size;
+    }
+    return ptr;
+}
+
+void countedDeallocate(void* ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    if (counting)
+    {
+        ++threadStats.deallocations;
+    }
+    std::free(ptr);
+}
+
+} // namespace
+
+namespace joc
+{
+namespace test
+{
+
+AllocationScope::AllocationScope()
+{
+    threadStats = AllocationStats();
+    counting    = true;
+}
+
+AllocationScope::~AllocationScope()
+{
+    counting = false;
+}
+
+AllocationStats AllocationScope::stats() const
+{
+    return threadStats;
+}
+
+} // namespace test
+} // namespace joc
+
+void* operator new(std::size_t size)
+{
+    return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return countedAllocate(size, alignof(std::max_align_t));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return countedAllocate(size, alignof(std::max_align_t));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    countedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    countedDeallocate(ptr);
+}
@@ -0,0 +1,116 @@
+#ifndef TESTS_UT_ALLOCATIONCOUNTER_HPP_
+#define TESTS_UT_ALLOCATIONCOUNTER_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <utility>
+
+namespace joc
+{
+namespace test
+{
+
+/**
+ * @brief Heap activity of the calling thread, as seen by the global
+ *        operator new/delete replacements in AllocationCounter.cpp.
+ *        Linking AllocationCounter.cpp into a test executable enables them.
+ */
+struct AllocationStats
+{
+    std::size_t allocations{0};
+    std::size_t deallocations{0};
+    std::size_t bytes{0};
+};
+
+/**
+ * @brief Maximum heap activity accepted for an operation, as measured when the
+ *        budget was set:
+ *        - allocations: the number of allocations, which does not depend on the
+ *          size of the types.
+ *        - bytesPercent: the bytes allocated, as a percentage of the bytes of a
+ *          baseline operation measured in the same process (e.g. copying the JSON
+ *          value the operation produces), so that they follow the size of the
+ *          types of the platform.
+ *        The budgets are checked with kBudgetTolerancePercent of headroom. Lower a
+ *        budget when an optimization saves allocations, raise it only with the
+ *        reason in the commit that does it.
+ */
+struct AllocationBudget
+{
+    std::size_t allocations;
+    std::size_t bytesPercent;
+};
+
+/**
+ * @brief Increase accepted over a budget, in percent, so that versions of the
+ *        standard library and of nlohmann::json other than the ones the budgets
+ *        are measured with (libstdc++) do not fail them, while a regression that
+ *        allocates per element or per field still does.
+ */
+constexpr std::size_t kBudgetTolerancePercent = 20;
+
+/**
+ * @brief Counts the allocations of the calling thread while in scope.
+ *        Scopes must not be nested.
+ */
+class AllocationScope
+{
+public:
+    AllocationScope();
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    AllocationStats stats() const;
+};
+
+template<typename F>
+AllocationStats measureAllocations(F&& operation)
+{
+    AllocationScope scope;
+    std::forward<F>(operation)();
+    return scope.stats();
+}
+
+/**
+ * @return stats.bytes as a percentage of baseline.bytes, rounded up
+ */
+inline std::size_t bytesPercent(const AllocationStats& stats, const AllocationStats& baseline)
+{
+    if (baseline.bytes == 0)
+    {
+        return stats.bytes == 0 ? 0 : std::numeric_limits<std::size_t>::max();
+    }
+    return (stats.bytes * 100 + baseline.bytes - 1) / baseline.bytes;
+}
+
+inline bool isWithinBudget(const AllocationStats& stats, const AllocationBudget& budget, const AllocationStats& baseline)
+{
+    const auto withTolerance = [](std::size_t value) { return value + value * kBudgetTolerancePercent / 100; };
+    return stats.allocations <= withTolerance(budget.allocations)
+           && bytesPercent(stats, baseline) <= withTolerance(budget.bytesPercent);
+}
+
+inline bool isAllocationFree(const AllocationStats& stats)
+{
+    return stats.allocations == 0;
+}
+
+inline std::ostream& operator<<(std::ostream& os, const AllocationStats& stats)
+{
+    return os << stats.allocations << " allocations (" << stats.bytes << " bytes), " << stats.deallocations
+              << " deallocations";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const AllocationBudget& budget)
+{
+    return os << "budget of " << budget.allocations << " allocations (" << budget.bytesPercent
+              << "% of the baseline bytes)";
+}
+
+} // namespace test
+} // namespace joc
+
+#endif
@@ -0,0 +1,166 @@
+#include "JsonColumnar.hpp"
+#include "JsonObjectConverterImpl.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+using namespace std::chrono;
+
+namespace
+{
+// Vector-backed objects and single precision floating point numbers
+using FlatJson = nlohmann::basic_json<nlohmann::ordered_map, std::vector, std::string, bool, std::int64_t, std::uint64_t, float>;
+
+struct OrderedPoint : public OrderedJsonObject
+{
+    OrderedPoint()
+        : JsonObject({{"y", y}, {"x", x}}){};
+
+    int y{0};
+    int x{0};
+};
+
+struct OrderedShape : public OrderedJsonObject
+{
+    OrderedShape()
+        : JsonObject({
+            {"name", name},
+            {"closed", closed},
+            {"origin", origin},
+            {"points", points},
+            {"created", created, TimestampEncoding::Iso8601},
+            {"area", area},
+        }){};
+
+    std::string name;
+    bool closed{false};
+    OrderedPoint origin;
+    std::vector<OrderedPoint> points;
+    SystemTimePoint created;
+    std::optional<double> area;
+};
+
+struct FlatSample : public BasicJsonObject<FlatJson>
+{
+    FlatSample()
+        : JsonObject({{"id", id}, {"ratio", ratio}, {"tags", tags}, {"timeout", timeout}}){};
+
+    std::int64_t id{0};
+    float ratio{0.0f};
+    std::vector<std::string> tags;
+    milliseconds timeout{0};
+};
+} // namespace
+
+struct BasicJsonObjectTest : public Test
+{
+};
+
+TEST_F(BasicJsonObjectTest, OrderedToJson_KeepsDeclarationOrder)
+{
+    OrderedShape shape;
+    shape.name     = "triangle";
+    shape.origin.x = 1;
+    shape.points.resize(2);
+    shape.points[1].y = 3;
+    shape.created     = SystemTimePoint(seconds(1614834367));
+
+    const nlohmann::ordered_json j = shape.toJson();
+    EXPECT_EQ(
+        j.dump(),
+        R"({"name":"triangle","closed":false,"origin":{"y":0,"x":1},"points":[{"y":0,"x":0},{"y":3,"x":0}],"created":"2021-03-04T05:06:07Z"})");
+
+    // Same content as the map-backed conversion, only the order differs
+    EXPECT_EQ(nlohmann::json::parse(j.dump()), nlohmann::json::parse(shape.toJson().dump()));
+}
+
+TEST_F(BasicJsonObjectTest, OrderedRefreshFromJson_Works)
+{
+    OrderedShape shape;
+    ASSERT_TRUE(shape.refreshFromJson(nlohmann::ordered_json::parse(
+        R"({"area":2.5,"points":[{"x":1,"y":2}],"origin":{"x":3,"y":4},"closed":true,"name":"line","created":"2021-03-04T05:06:07.5Z"})")));
+
+    EXPECT_EQ(shape.name, "line");
+    EXPECT_TRUE(shape.closed);
+    EXPECT_EQ(shape.origin.x, 3);
+    EXPECT_EQ(shape.origin.y, 4);
+    ASSERT_EQ(shape.points.size(), 1);
+    EXPECT_EQ(shape.points[0].x, 1);
+    EXPECT_EQ(shape.created, SystemTimePoint(milliseconds(1614834367500)));
+    EXPECT_EQ(shape.area, 2.5);
+
+    EXPECT_FALSE(shape.refreshFromJson(nlohmann::ordered_json::parse(R"({"name":1})")));
+}
+
+TEST_F(BasicJsonObjectTest, OrderedFieldAccessAndComparison_Works)
+{
+    OrderedShape shape;
+    shape.points.resize(1);
+    shape.points[0].x = 5;
+
+    const auto* x = shape.getByPointer<int>("/points/0/x");
+    ASSERT_NE(x, nullptr);
+    EXPECT_EQ(*x, 5);
+    EXPECT_TRUE(shape.set("name", std::string("square")));
+
+    OrderedShape copy(shape);
+    EXPECT_EQ(copy, shape);
+    EXPECT_EQ(copy.fingerprint(), shape.fingerprint());
+    copy.points[0].x = 6;
+    EXPECT_NE(copy, shape);
+}
+
+TEST_F(BasicJsonObjectTest, OrderedUnknownKeys_KeepReceivedOrder)
+{
+    OrderedPoint point;
+    point.setKeepUnknownKeys(true);
+    ASSERT_TRUE(point.refreshFromJson(nlohmann::ordered_json::parse(R"({"z":1,"x":2,"label":"p","y":3})")));
+
+    point.x = 4;
+    EXPECT_EQ(point.toJson().dump(), R"({"y":3,"x":4,"z":1,"label":"p"})");
+}
+
+TEST_F(BasicJsonObjectTest, OrderedColumnar_KeepsDeclarationOrder)
+{
+    std::vector<OrderedPoint> points(2);
+    points[1].x = 7;
+
+    const auto columnar = toColumnarJson(points);
+    EXPECT_EQ(columnar.dump(), R"({"y":[0,0],"x":[0,7]})");
+
+    std::vector<OrderedPoint> decoded;
+    ASSERT_TRUE(refreshFromColumnarMsgPack(toColumnarMsgPack(points), decoded));
+    ASSERT_EQ(decoded.size(), 2);
+    EXPECT_EQ(decoded[1].x, 7);
+}
+
+TEST_F(BasicJsonObjectTest, CustomBasicJson_Works)
+{
+    FlatSample sample;
+    sample.id      = 42;
+    sample.ratio   = 0.5f;
+    sample.tags    = {"b", "a"};
+    sample.timeout = milliseconds(250);
+
+    const FlatJson j = sample.toJson();
+    EXPECT_EQ(j.dump(), R"({"id":42,"ratio":0.5,"tags":["b","a"],"timeout":250})");
+    EXPECT_TRUE(j["ratio"].is_number_float());
+
+    FlatSample decoded;
+    ASSERT_TRUE(decoded.refreshFromJson(FlatJson::parse(R"({"timeout":10,"tags":[],"ratio":1.25,"id":-1})")));
+    EXPECT_EQ(decoded.id, -1);
+    EXPECT_EQ(decoded.ratio, 1.25f);
+    EXPECT_TRUE(decoded.tags.empty());
+    EXPECT_EQ(decoded.timeout, milliseconds(10));
+
+    FlatSample copy(sample);
+    EXPECT_EQ(copy, sample);
+    EXPECT_NE(copy, decoded);
+}
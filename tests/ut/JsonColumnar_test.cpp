@@ -0,0 +1,125 @@
+#include "JsonColumnar.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <deque>
+#include <list>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+
+namespace
+{
+std::vector<Contact> makeContacts(int count)
+{
+    std::vector<Contact> contacts(count);
+    for (int i = 0; i < count; ++i)
+    {
+        contacts[i].name    = "Name" + std::to_string(i);
+        contacts[i].address = "Street " + std::to_string(i);
+        contacts[i].age     = 20 + i;
+        contacts[i].type    = (i % 2 == 0) ? ContactType::Friend : ContactType::Work;
+        if (i % 3 == 0)
+        {
+            contacts[i].email = "name" + std::to_string(i) + "@hisspace.com";
+        }
+    }
+    return contacts;
+}
+} // namespace
+
+struct JsonColumnarTest : public Test
+{
+};
+
+TEST_F(JsonColumnarTest, ToColumnarJson_Works)
+{
+    const auto columnar = toColumnarJson(makeContacts(3));
+
+    EXPECT_EQ(
+        columnar.dump(),
+        R"({"address":["Street 0","Street 1","Street 2"],"age":[20,21,22],"e-mail":["name0@hisspace.com",null,null],"name":["Name0","Name1","Name2"],"type":["Friend","Work","Friend"]})");
+}
+
+TEST_F(JsonColumnarTest, ToColumnarJsonEmpty_HasEmptyColumns)
+{
+    EXPECT_EQ(toColumnarJson(std::list<TestStruct>()).dump(), R"({"a":[],"b":[],"c":[]})");
+}
+
+TEST_F(JsonColumnarTest, Roundtrip_Works)
+{
+    const auto contacts = makeContacts(10);
+
+    std::deque<Contact> decoded;
+    ASSERT_TRUE(refreshFromColumnarJson(toColumnarJson(contacts), decoded));
+    ASSERT_EQ(decoded.size(), contacts.size());
+    for (std::size_t i = 0; i < contacts.size(); ++i)
+    {
+        EXPECT_EQ(decoded[i].toJson(), contacts[i].toJson());
+    }
+}
+
+TEST_F(JsonColumnarTest, RefreshFromColumnarJson_ReusesRows)
+{
+    std::vector<TestStruct> rows(5);
+    rows[0].c = 1.0;
+
+    ASSERT_TRUE(refreshFromColumnarJson(R"({"a":[1,2],"b":["x","y"],"c":[null,2.5]})"_json, rows));
+    ASSERT_EQ(rows.size(), 2);
+    EXPECT_EQ(rows[0].toJson().dump(), R"({"a":1,"b":"x"})");
+    EXPECT_EQ(rows[1].toJson().dump(), R"({"a":2,"b":"y","c":2.5})");
+
+    // Missing optional column
+    EXPECT_TRUE(refreshFromColumnarJson(R"({"a":[3],"b":["z"]})"_json, rows));
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(rows[0].a, 3);
+}
+
+TEST_F(JsonColumnarTest, RefreshFromColumnarJson_Fails)
+{
+    std::vector<TestStruct> rows;
+    EXPECT_FALSE(refreshFromColumnarJson(R"([1, 2])"_json, rows));
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1,2],"b":["x"]})"_json, rows));
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":1,"b":"x"})"_json, rows));
+    // Missing mandatory column
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1,2]})"_json, rows));
+    EXPECT_FALSE(refreshFromColumnarJson(R"({})"_json, rows));
+    // Invalid type
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1,"2"],"b":["x","y"]})"_json, rows));
+}
+
+TEST_F(JsonColumnarTest, RefreshFromColumnarJsonInvalid_KeepsRows)
+{
+    std::vector<TestStruct> rows(2);
+    rows[1].a = 5;
+
+    // No columns at all, or none of the fields
+    EXPECT_FALSE(refreshFromColumnarJson(R"({})"_json, rows));
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"foo":[1,2,3]})"_json, rows));
+    // Missing mandatory column "b"
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1],"c":[null]})"_json, rows));
+    // Columns of different lengths
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1],"b":["x","y","z"]})"_json, rows));
+    EXPECT_FALSE(refreshFromColumnarJson(R"({"a":[1,2,3],"b":["x","y","z"],"c":[null]})"_json, rows));
+
+    ASSERT_EQ(rows.size(), 2);
+    EXPECT_EQ(rows[1].a, 5);
+}
+
+TEST_F(JsonColumnarTest, MsgPack_IsSmallerThanRows)
+{
+    const auto contacts = makeContacts(100);
+
+    const auto msgPack = toColumnarMsgPack(contacts);
+    EXPECT_LT(msgPack.size(), nlohmann::json::to_msgpack(nlohmann::json(contacts)).size());
+
+    std::vector<Contact> decoded;
+    ASSERT_TRUE(refreshFromColumnarMsgPack(msgPack, decoded));
+    ASSERT_EQ(decoded.size(), contacts.size());
+    EXPECT_EQ(decoded.back().toJson(), contacts.back().toJson());
+
+    EXPECT_FALSE(refreshFromColumnarMsgPack({0xc1}, decoded));
+}
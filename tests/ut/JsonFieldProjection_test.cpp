@@ -0,0 +1,201 @@
+#include "AllocationCounter.hpp"
+#include "JsonColumnar.hpp"
+#include "JsonFieldProjection.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <map>
+
+using namespace ::testing;
+using namespace joc;
+using namespace joc::test;
+
+namespace
+{
+ContactBook makeBook()
+{
+    ContactBook book;
+    book.owner = "Ricardo";
+    book.contactList.resize(2);
+    book.contactList.front().name  = "Mary";
+    book.contactList.front().age   = 52;
+    book.contactList.front().email = "mary@herspace.com";
+    book.contactList.back().name   = "Peter";
+    book.contactList.back().age    = 34;
+    return book;
+}
+
+struct Record : public JsonObject
+{
+    // The name is only a field of named records
+    explicit Record(bool named)
+        : JsonObject(named ? std::vector<JsonPair>{{"name", name}, {"id", id}} : std::vector<JsonPair>{{"id", id}}){};
+
+    std::string name{"record"};
+    int id{0};
+};
+
+std::vector<std::string> keys(const FieldProjection& projection)
+{
+    std::vector<std::string> keys;
+    for (const auto& field : projection.fields())
+    {
+        keys.push_back(field.key);
+    }
+    return keys;
+}
+} // namespace
+
+struct JsonFieldProjectionTest : public Test
+{
+};
+
+TEST_F(JsonFieldProjectionTest, Parse_Works)
+{
+    const auto projection = FieldProjection::parse(" owner, contact_list/name,,contact_list/age ,/extra");
+
+    EXPECT_THAT(keys(projection), ElementsAre("owner", "contact_list", "extra"));
+    ASSERT_NE(projection.find("owner"), nullptr);
+    EXPECT_TRUE(projection.find("owner")->whole);
+
+    const auto* contactList = projection.find("contact_list");
+    ASSERT_NE(contactList, nullptr);
+    EXPECT_FALSE(contactList->whole);
+    EXPECT_THAT(keys(contactList->nested), ElementsAre("name", "age"));
+
+    EXPECT_EQ(projection.find("name"), nullptr);
+    EXPECT_TRUE(FieldProjection::parse("").empty());
+}
+
+TEST_F(JsonFieldProjectionTest, WholeField_OverridesSubPaths)
+{
+    const FieldProjection before{"contact_list", "contact_list/name"};
+    const FieldProjection after{"contact_list/name", "contact_list"};
+
+    for (const auto* projection : {&before, &after})
+    {
+        const auto* field = projection->find("contact_list");
+        ASSERT_NE(field, nullptr);
+        EXPECT_TRUE(field->whole);
+        EXPECT_TRUE(field->nested.empty());
+    }
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_SkipsUnselectedFields)
+{
+    const auto book = makeBook();
+
+    EXPECT_EQ(book.toJson(FieldProjection{"owner"}).dump(), R"({"owner":"Ricardo"})");
+    EXPECT_EQ(book.toJson(FieldProjection{"owner", "missing"}).dump(), R"({"owner":"Ricardo"})");
+    EXPECT_EQ(book.toJson(FieldProjection()).dump(), R"({})");
+    EXPECT_EQ(book.toJson(FieldProjection{"owner", "contact_list"}), book.toJson());
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_ResolvesPerKeysOfObject)
+{
+    Record named(true);
+    named.id = 1;
+    Record anonymous(false);
+    anonymous.id = 2;
+
+    const FieldProjection projection{"id", "name"};
+    EXPECT_EQ(named.toJson(projection).dump(), R"({"id":1,"name":"record"})");
+    EXPECT_EQ(anonymous.toJson(projection).dump(), R"({"id":2})");
+    EXPECT_EQ(named.toJson(projection).dump(), R"({"id":1,"name":"record"})");
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_ProjectsNestedObjects)
+{
+    const auto book = makeBook();
+
+    EXPECT_EQ(book.toJson(FieldProjection::parse("contact_list/name,contact_list/e-mail")).dump(),
+              R"({"contact_list":[{"e-mail":"mary@herspace.com","name":"Mary"},{"name":"Peter"}]})");
+
+    struct Directory : public JsonObject
+    {
+        Directory()
+            : JsonObject({{"main", main}, {"backup", backup}, {"by_name", byName}}){};
+        Contact main;
+        std::optional<Contact> backup;
+        std::map<std::string, Contact> byName;
+    };
+
+    Directory directory;
+    directory.main.name       = "Mary";
+    directory.byName["peter"] = book.contactList.back();
+    const auto projection     = FieldProjection::parse("main/name,backup/name,by_name/age");
+
+    EXPECT_EQ(directory.toJson(projection).dump(), R"({"by_name":{"peter":{"age":34}},"main":{"name":"Mary"}})");
+    directory.backup = book.contactList.front();
+    EXPECT_EQ(directory.toJson(projection)["backup"].dump(), R"({"name":"Mary"})");
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_SubPathsOfValues_SelectWholeValue)
+{
+    TestStruct t;
+    t.a = 5;
+
+    EXPECT_EQ(t.toJson(FieldProjection{"a/x"}).dump(), R"({"a":5})");
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_SelectsUnknownKeys)
+{
+    TestStruct t;
+    t.setKeepUnknownKeys(true);
+    ASSERT_TRUE(t.refreshFromJson(R"({"a":1,"b":"T1","extra":[1,2],"other":true})"_json));
+
+    EXPECT_EQ(t.toJson(FieldProjection{"a", "extra"}).dump(), R"({"a":1,"extra":[1,2]})");
+}
+
+TEST_F(JsonFieldProjectionTest, ToColumnarJson_Works)
+{
+    const auto book = makeBook();
+
+    const auto projection = FieldProjection::parse("name,e-mail,missing");
+    EXPECT_EQ(toColumnarJson(book.contactList, projection).dump(),
+              R"({"e-mail":["mary@herspace.com",null],"name":["Mary","Peter"]})");
+    EXPECT_EQ(toColumnarJson(std::vector<Contact>(), projection).dump(), R"({"e-mail":[],"name":[]})");
+
+    // The mandatory fields that are not selected are reported as missing, before any row is converted
+    std::vector<Contact> decoded(1);
+    EXPECT_FALSE(refreshFromColumnarMsgPack(toColumnarMsgPack(book.contactList, FieldProjection{"name", "age"}), decoded));
+    ASSERT_EQ(decoded.size(), 1);
+    EXPECT_EQ(decoded.front(), Contact());
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_SkipsUnselectedFieldsWithoutAllocating)
+{
+    ContactBook emptyBook;
+    emptyBook.owner = "a string too long for small string optimization";
+    ContactBook book;
+    book.owner = emptyBook.owner;
+    book.contactList.resize(1000);
+    const auto projection = FieldProjection::parse("owner");
+
+    // The projection is resolved by the first conversion
+    const auto emptyStats = measureAllocations([&emptyBook, &projection]() { emptyBook.toJson(projection); });
+    const auto stats      = measureAllocations([&book, &projection]() { book.toJson(projection); });
+    // Independent of the size of the skipped contact list
+    EXPECT_LE(stats.allocations, emptyStats.allocations) << stats << ", " << emptyStats;
+    EXPECT_LE(stats.bytes, emptyStats.bytes) << stats << ", " << emptyStats;
+}
+
+TEST_F(JsonFieldProjectionTest, ToJson_ResolvesNestedProjectionOncePerClass)
+{
+    // Objects and projection never used before
+    ContactBook book;
+    book.contactList.resize(1000);
+    const auto projection = FieldProjection::parse("contact_list/age");
+
+    const auto firstStats    = measureAllocations([&book, &projection]() { book.toJson(projection); });
+    const auto repeatedStats = measureAllocations([&book, &projection]() { book.toJson(projection); });
+    const auto fullStats     = measureAllocations([&book]() { book.toJson(); });
+    // Resolving the projection per contact would allocate at least once per contact
+    EXPECT_LT(firstStats.allocations, repeatedStats.allocations + book.contactList.size() / 10)
+        << firstStats << ", " << repeatedStats;
+    // One object per contact, with one of its five members
+    EXPECT_LT(repeatedStats.allocations * 2, fullStats.allocations) << repeatedStats << ", " << fullStats;
+    EXPECT_LT(repeatedStats.bytes * 2, fullStats.bytes) << repeatedStats << ", " << fullStats;
+}
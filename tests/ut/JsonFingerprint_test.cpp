@@ -0,0 +1,277 @@
+#include "AllocationCounter.hpp"
+#include "JsonObjectConverter.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+using namespace joc::test;
+
+namespace
+{
+Contact makeContact(const std::string& name, int age)
+{
+    Contact c;
+    c.name    = name;
+    c.address = "Olof Str. 4";
+    c.age     = age;
+    c.type    = ContactType::Friend;
+    return c;
+}
+
+// A type with JSON conversions but without operator==
+struct Point
+{
+    int x{0};
+    int y{0};
+};
+
+void to_json(nlohmann::json& j, const Point& p)
+{
+    j = {p.x, p.y};
+}
+
+void from_json(const nlohmann::json& j, Point& p)
+{
+    p.x = j.at(0);
+    p.y = j.at(1);
+}
+
+struct Shape : public JsonObject
+{
+    Shape()
+        : JsonObject({{"points", points}, {"labels", labels}, {"origin", origin}}){};
+    std::vector<Point> points;
+    std::map<std::string, int> labels;
+    std::optional<Point> origin;
+};
+} // namespace
+
+struct JsonFingerprintTest : public Test
+{
+};
+
+TEST_F(JsonFingerprintTest, Hasher_IsStable)
+{
+    FingerprintHasher hasher;
+    hasher.update(std::string_view("joc"));
+    hasher.update(42);
+    // Must not change between builds, it would invalidate stored fingerprints
+    EXPECT_EQ(hasher.digest(), 0xcfa9a763722d8608ULL);
+
+    TestStruct t;
+    t.c = 2.5;
+    EXPECT_EQ(t.fingerprint(), 0x61306726fb059b05ULL);
+
+    FingerprintHasher empty;
+    FingerprintHasher emptyString;
+    emptyString.update(std::string_view());
+    EXPECT_NE(empty.digest(), emptyString.digest());
+}
+
+TEST_F(JsonFingerprintTest, EqualObjects_HaveEqualFingerprints)
+{
+    TestStruct t1, t2;
+    EXPECT_EQ(t1, t2);
+    EXPECT_EQ(t1.fingerprint(), t2.fingerprint());
+
+    t1.a = 5;
+    EXPECT_NE(t1, t2);
+    EXPECT_NE(t1.fingerprint(), t2.fingerprint());
+
+    t2.a = 5;
+    t1.c = 1.5;
+    EXPECT_NE(t1, t2);
+    EXPECT_NE(t1.fingerprint(), t2.fingerprint());
+
+    t2.refreshFromJson(t1.toJson());
+    EXPECT_EQ(t1, t2);
+    EXPECT_EQ(t1.fingerprint(), t2.fingerprint());
+
+    TestStruct copy = t1;
+    EXPECT_EQ(copy, t1);
+    EXPECT_EQ(copy.fingerprint(), t1.fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, FieldOrderAndKeys_Matter)
+{
+    struct AB : public JsonObject
+    {
+        AB()
+            : JsonObject({{"a", a}, {"b", b}}){};
+        int a{1};
+        int b{2};
+    };
+    struct BA : public JsonObject
+    {
+        BA()
+            : JsonObject({{"b", b}, {"a", a}}){};
+        int a{1};
+        int b{2};
+    };
+    struct AC : public JsonObject
+    {
+        AC()
+            : JsonObject({{"a", a}, {"c", b}}){};
+        int a{1};
+        int b{2};
+    };
+
+    EXPECT_NE(AB(), BA());
+    EXPECT_NE(AB().fingerprint(), BA().fingerprint());
+    EXPECT_NE(AB(), AC());
+    EXPECT_NE(AB().fingerprint(), AC().fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, NestedObjects_AreCompared)
+{
+    ContactBook b1, b2;
+    b1.owner = b2.owner = "Ricardo";
+    b1.contactList      = {makeContact("Mary", 52), makeContact("Peter", 34)};
+    b2.contactList      = b1.contactList;
+    EXPECT_EQ(b1, b2);
+    EXPECT_EQ(b1.fingerprint(), b2.fingerprint());
+
+    b2.contactList.back().email = "peter@hisspace.com";
+    EXPECT_NE(b1, b2);
+    EXPECT_NE(b1.fingerprint(), b2.fingerprint());
+
+    b2.contactList.pop_back();
+    EXPECT_NE(b1, b2);
+    EXPECT_NE(b1.fingerprint(), b2.fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, TypesWithoutEquality_AreComparedAsJson)
+{
+    Shape s1, s2;
+    s1.points = s2.points = {{1, 2}, {3, 4}};
+    s1.labels = s2.labels = {{"x", 1}};
+    EXPECT_EQ(s1, s2);
+    EXPECT_EQ(s1.fingerprint(), s2.fingerprint());
+
+    s2.points.back().y = 5;
+    EXPECT_NE(s1, s2);
+    EXPECT_NE(s1.fingerprint(), s2.fingerprint());
+
+    s2.points.back().y = 4;
+    s2.origin          = Point();
+    EXPECT_NE(s1, s2);
+    EXPECT_NE(s1.fingerprint(), s2.fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, UnorderedContainers_AreComparedRegardlessOfOrder)
+{
+    struct Index : public JsonObject
+    {
+        Index()
+            : JsonObject({{"counts", counts}, {"points", points}, {"tags", tags}}){};
+        std::unordered_map<std::string, int> counts;
+        std::unordered_map<std::string, Point> points;
+        std::unordered_set<int> tags;
+    };
+
+    // Same elements, inserted in opposite orders into tables of different sizes
+    Index i1, i2;
+    i2.counts.rehash(1024);
+    i2.points.rehash(1024);
+    i2.tags.rehash(1024);
+    for (int i = 0; i < 100; ++i)
+    {
+        const int j = 99 - i;
+        i1.counts["key" + std::to_string(i)] = i;
+        i2.counts["key" + std::to_string(j)] = j;
+        i1.points["key" + std::to_string(i)] = Point{i, i};
+        i2.points["key" + std::to_string(j)] = Point{j, j};
+        i1.tags.insert(i);
+        i2.tags.insert(j);
+    }
+    ASSERT_EQ(i1.counts, i2.counts);
+    EXPECT_EQ(i1, i2);
+    EXPECT_EQ(i1.fingerprint(), i2.fingerprint());
+
+    i2.points["key5"].y = 6;
+    EXPECT_NE(i1, i2);
+    EXPECT_NE(i1.fingerprint(), i2.fingerprint());
+
+    i2.points["key5"].y = 5;
+    i2.tags.erase(5);
+    i2.tags.insert(100);
+    EXPECT_NE(i1, i2);
+    EXPECT_NE(i1.fingerprint(), i2.fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, JsonValues_AreHashedByValue)
+{
+    struct Document : public JsonObject
+    {
+        Document()
+            : JsonObject({{"value", value}}){};
+        nlohmann::json value;
+    };
+
+    Document d1, d2;
+    d1.value = R"({"a":1,"b":[-0.0,2,{"c":null}],"d":"text"})"_json;
+    d2.value = R"({"d":"text","b":[0,2.0,{"c":null}],"a":1.0})"_json;
+    ASSERT_EQ(d1.value, d2.value);
+    EXPECT_EQ(d1, d2);
+    EXPECT_EQ(d1.fingerprint(), d2.fingerprint());
+
+    d2.value = 1U;
+    d1.value = 1.0;
+    EXPECT_EQ(d1, d2);
+    EXPECT_EQ(d1.fingerprint(), d2.fingerprint());
+
+    d2.value = "1";
+    EXPECT_NE(d1, d2);
+    EXPECT_NE(d1.fingerprint(), d2.fingerprint());
+
+    d1.value = R"([1,2])"_json;
+    d2.value = R"([2,1])"_json;
+    EXPECT_NE(d1.fingerprint(), d2.fingerprint());
+    d1.value = R"({"a":true})"_json;
+    d2.value = R"({"a":false})"_json;
+    EXPECT_NE(d1.fingerprint(), d2.fingerprint());
+}
+
+TEST_F(JsonFingerprintTest, ComparisonWithMutexes_Works)
+{
+    std::mutex m1, m2;
+    TestStruct t1, t2;
+    t1.setDataMutex(&m1);
+    t2.setDataMutex(&m2);
+    EXPECT_EQ(t1, t2);
+    EXPECT_EQ(t1, t1);
+
+    t2.setDataMutex(&m1);
+    EXPECT_EQ(t1, t2);
+}
+
+TEST_F(JsonFingerprintTest, FingerprintAndComparison_AreAllocationFree)
+{
+    ContactBook book;
+    book.owner       = "Ricardo";
+    book.contactList = {makeContact("Mary", 52), makeContact("Peter", 34), makeContact("Joana", 27)};
+    const ContactBook copy = book;
+
+    // JSON values, here the unknown keys, are hashed without being dumped
+    TestStruct withUnknownKeys;
+    withUnknownKeys.setKeepUnknownKeys(true);
+    withUnknownKeys.refreshFromJson(R"({"a":1,"b":"x","extra":{"numbers":[1,2.5],"text":"a string too long for SSO"}})"_json);
+
+    bool equal       = false;
+    const auto stats = measureAllocations([&]() {
+        book.fingerprint();
+        withUnknownKeys.fingerprint();
+        equal = (book == copy);
+    });
+    EXPECT_TRUE(equal);
+    EXPECT_TRUE(isAllocationFree(stats)) << stats;
+}
@@ -0,0 +1,251 @@
+#include "AllocationCounter.hpp"
+#include "JsonObjectConverter.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+using namespace joc::test;
+
+namespace
+{
+struct Envelope : public JsonObject
+{
+    Envelope()
+        : JsonObject({{"id", id}, {"book", book}, {"ids", ids}}){};
+
+    int id{0};
+    Lazy<ContactBook> book;
+    Lazy<std::vector<int>> ids;
+};
+
+struct OrderedPoint : public OrderedJsonObject
+{
+    OrderedPoint()
+        : OrderedJsonObject({{"x", x}, {"y", y}}){};
+
+    int x{0};
+    int y{0};
+};
+
+struct OrderedEnvelope : public OrderedJsonObject
+{
+    OrderedEnvelope()
+        : OrderedJsonObject({{"point", point}, {"ids", ids}}){};
+
+    Lazy<OrderedPoint> point;
+    Lazy<std::vector<int>, nlohmann::ordered_json> ids;
+};
+
+/**
+ * Converted from a copy of its JSON value, which is not part of the document
+ */
+struct Copied
+{
+    Lazy<std::vector<int>> ids;
+};
+
+void to_json(nlohmann::json& j, const Copied& copied)
+{
+    j = copied.ids;
+}
+
+void from_json(const nlohmann::json& j, Copied& copied)
+{
+    const auto copy = j;
+    copy.get_to(copied.ids);
+}
+
+bool operator==(const Copied& lhs, const Copied& rhs)
+{
+    return lhs.ids.get() == rhs.ids.get();
+}
+
+struct CopyingEnvelope : public JsonObject
+{
+    CopyingEnvelope()
+        : JsonObject({{"copied", copied}, {"books", books}}){};
+
+    Copied copied;
+    std::vector<Lazy<ContactBook>> books;
+};
+
+const auto MESSAGE_JSON = R"({
+    "id": 7,
+    "book": {"owner": "Ricardo", "contact_list": [{"type": "Friend", "name": "Mary", "address": "Lisboa", "age": 52}]},
+    "ids": [3, 1, 2]
+})"_json;
+} // namespace
+
+struct JsonLazyTest : public Test
+{
+};
+
+TEST_F(JsonLazyTest, RefreshFromJson_DefersConversion)
+{
+    Envelope message;
+    ASSERT_TRUE(message.refreshFromJson(MESSAGE_JSON));
+    EXPECT_EQ(message.id, 7);
+    EXPECT_FALSE(message.book.isDecoded());
+    EXPECT_FALSE(message.ids.isDecoded());
+    ASSERT_NE(message.book.raw(), nullptr);
+    EXPECT_EQ(*message.book.raw(), MESSAGE_JSON["book"]);
+
+    EXPECT_EQ(message.book->owner, "Ricardo");
+    ASSERT_EQ(message.book->contactList.size(), 1);
+    EXPECT_EQ(message.book->contactList.front().age, 52);
+    EXPECT_TRUE(message.book.isDecoded());
+    EXPECT_FALSE(message.ids.isDecoded());
+    EXPECT_EQ(message.ids.get(), std::vector<int>({3, 1, 2}));
+}
+
+TEST_F(JsonLazyTest, RefreshFromJson_ChecksType)
+{
+    Envelope message;
+    EXPECT_FALSE(message.refreshFromJson(R"({"id": 1, "book": [], "ids": []})"_json));
+    EXPECT_FALSE(message.refreshFromJson(R"({"id": 1, "ids": []})"_json));
+}
+
+TEST_F(JsonLazyTest, ToJson_WritesRawUntilModified)
+{
+    Envelope message;
+    ASSERT_TRUE(message.refreshFromJson(MESSAGE_JSON));
+    EXPECT_EQ(message.toJson(), MESSAGE_JSON);
+
+    // Reading does not change the output
+    message.book.get();
+    EXPECT_EQ(message.toJson(), MESSAGE_JSON);
+
+    message.book.getMutable().owner = "Joana";
+    message.ids                     = std::vector<int>{4};
+    EXPECT_EQ(message.book.raw(), nullptr);
+    const auto j = message.toJson();
+    EXPECT_EQ(j["book"]["owner"], "Joana");
+    EXPECT_EQ(j["book"]["contact_list"], MESSAGE_JSON["book"]["contact_list"]);
+    EXPECT_EQ(j["ids"], nlohmann::json({4}));
+}
+
+TEST_F(JsonLazyTest, RefreshFromSharedDocument_ReferencesDocument)
+{
+    auto document = std::make_shared<const nlohmann::json>(MESSAGE_JSON);
+    std::weak_ptr<const nlohmann::json> weak = document;
+
+    Envelope message;
+    ASSERT_TRUE(message.refreshFromJson(document));
+    EXPECT_EQ(message.book.raw(), &(*document)["book"]);
+    EXPECT_EQ(message.ids.raw(), &(*document)["ids"]);
+
+    // The lazy members keep the document alive
+    document.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(message.book->owner, "Ricardo");
+    message.book = ContactBook();
+    message.ids  = std::vector<int>();
+    EXPECT_TRUE(weak.expired());
+
+    EXPECT_FALSE(message.refreshFromJson(std::shared_ptr<const nlohmann::json>()));
+}
+
+TEST_F(JsonLazyTest, CopyAndComparison_Work)
+{
+    Envelope message;
+    ASSERT_TRUE(message.refreshFromJson(MESSAGE_JSON));
+    const Envelope copy(message);
+    EXPECT_EQ(copy.book.raw(), message.book.raw());
+
+    // Compared by value, whatever the raw form
+    Envelope decoded;
+    decoded.id = 7;
+    decoded.book.getMutable().owner = "Ricardo";
+    decoded.book.getMutable().contactList.resize(1);
+    auto& contact   = decoded.book.getMutable().contactList.front();
+    contact.type    = ContactType::Friend;
+    contact.name    = "Mary";
+    contact.address = "Lisboa";
+    contact.age     = 52;
+    decoded.ids     = std::vector<int>{3, 1, 2};
+
+    EXPECT_EQ(decoded, message);
+    EXPECT_EQ(decoded.fingerprint(), message.fingerprint());
+    decoded.ids.getMutable().push_back(4);
+    EXPECT_NE(decoded, message);
+}
+
+TEST_F(JsonLazyTest, ConcurrentGet_ConvertsOnce)
+{
+    Envelope message;
+    ASSERT_TRUE(message.refreshFromJson(MESSAGE_JSON));
+    const auto& book = message.book;
+
+    std::vector<const ContactBook*> values(4, nullptr);
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        readers.emplace_back([&book, &values, i]() { values[i] = &book.get(); });
+    }
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    for (const auto* value : values)
+    {
+        EXPECT_EQ(value, &book.get());
+    }
+    EXPECT_EQ(book->owner, "Ricardo");
+}
+
+TEST_F(JsonLazyTest, OrderedJsonObject_UsesItsJsonType)
+{
+    static_assert(std::is_same_v<Lazy<OrderedPoint>::JsonType, nlohmann::ordered_json>);
+    static_assert(std::is_same_v<Lazy<ContactBook>::JsonType, nlohmann::json>);
+
+    OrderedEnvelope envelope;
+    ASSERT_TRUE(envelope.refreshFromJson(nlohmann::ordered_json::parse(R"({"point": {"y": 2, "x": 1}, "ids": [1]})")));
+    EXPECT_EQ(envelope.point->y, 2);
+    EXPECT_EQ(envelope.ids.get(), std::vector<int>({1}));
+    EXPECT_EQ(envelope.toJson().dump(), R"({"point":{"y":2,"x":1},"ids":[1]})");
+}
+
+TEST_F(JsonLazyTest, RefreshFromSharedDocument_CopiesValuesOutsideIt)
+{
+    auto document = std::make_shared<const nlohmann::json>(R"({
+        "copied": [3, 1, 2],
+        "books": [{"owner": "Ricardo", "contact_list": []}]
+    })"_json);
+    std::weak_ptr<const nlohmann::json> weak = document;
+
+    CopyingEnvelope envelope;
+    ASSERT_TRUE(envelope.refreshFromJson(document));
+    // The elements of an array of the document are referenced
+    ASSERT_EQ(envelope.books.size(), 1);
+    EXPECT_EQ(envelope.books.front().raw(), &(*document)["books"][0]);
+    // The copy made by from_json is not
+    ASSERT_NE(envelope.copied.ids.raw(), nullptr);
+    EXPECT_EQ(*envelope.copied.ids.raw(), nlohmann::json({3, 1, 2}));
+
+    document.reset();
+    EXPECT_FALSE(weak.expired());
+    envelope.books.clear();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(envelope.copied.ids.get(), std::vector<int>({3, 1, 2}));
+}
+
+TEST_F(JsonLazyTest, RefreshFromSharedDocument_IsAllocationFree)
+{
+    Envelope sample;
+    sample.id = 1;
+    sample.book.getMutable().contactList.resize(1000);
+    const auto document = std::make_shared<const nlohmann::json>(sample.toJson());
+
+    Envelope target;
+    target.refreshFromJson(document);
+    const auto stats = measureAllocations([&target, &document]() { target.refreshFromJson(document); });
+    EXPECT_TRUE(isAllocationFree(stats)) << stats;
+}
@@ -0,0 +1,187 @@
+#include "JsonObjectConverter.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+
+namespace
+{
+std::string encode(std::string_view bytes)
+{
+    std::string text(base64EncodedLength(bytes.size()), '\0');
+    encodeBase64(bytes.data(), bytes.size(), &text[0]);
+    return text;
+}
+
+std::optional<std::string> decode(std::string_view text)
+{
+    const auto length = base64DecodedLength(text);
+    if (length == std::numeric_limits<std::size_t>::max())
+    {
+        return std::nullopt;
+    }
+    std::string bytes(length, '\0');
+    if (!decodeBase64(text, &bytes[0]))
+    {
+        return std::nullopt;
+    }
+    return bytes;
+}
+
+struct Telemetry : public JsonObject
+{
+    Telemetry()
+        : JsonObject({
+            {"samples", samples},
+            {"counters", counters},
+            {"packed", packed, NumericArrayEncoding::Base64},
+            {"gains", gains},
+            {"offsets", offsets, NumericArrayEncoding::Base64},
+        }){};
+
+    std::vector<double> samples;
+    std::vector<std::int64_t> counters;
+    std::vector<float> packed;
+    std::array<int, 3> gains{};
+    std::optional<std::vector<std::uint16_t>> offsets;
+};
+} // namespace
+
+struct JsonNumericArrayCodecTest : public Test
+{
+};
+
+TEST_F(JsonNumericArrayCodecTest, Base64_Works)
+{
+    // RFC 4648 test vectors
+    EXPECT_EQ(encode(""), "");
+    EXPECT_EQ(encode("f"), "Zg==");
+    EXPECT_EQ(encode("fo"), "Zm8=");
+    EXPECT_EQ(encode("foo"), "Zm9v");
+    EXPECT_EQ(encode("foob"), "Zm9vYg==");
+    EXPECT_EQ(encode("fooba"), "Zm9vYmE=");
+    EXPECT_EQ(encode("foobar"), "Zm9vYmFy");
+
+    EXPECT_EQ(decode(""), "");
+    EXPECT_EQ(decode("Zg=="), "f");
+    EXPECT_EQ(decode("Zm8="), "fo");
+    EXPECT_EQ(decode("Zm9vYmFy"), "foobar");
+    EXPECT_EQ(decode("+/+/"), "\xfb\xff\xbf");
+
+    EXPECT_EQ(decode("Zg="), std::nullopt);
+    EXPECT_EQ(decode("Zg=a"), std::nullopt);
+    EXPECT_EQ(decode("Z=g="), std::nullopt);
+    EXPECT_EQ(decode("===="), std::nullopt);
+    EXPECT_EQ(decode("Zm9v YmFy"), std::nullopt);
+    EXPECT_EQ(decode("Zm9-"), std::nullopt);
+
+    EXPECT_TRUE(isBase64("Zm9vYg=="));
+    EXPECT_FALSE(isBase64("Zm9vY!=="));
+    EXPECT_FALSE(isBase64("Zg=a"));
+}
+
+TEST_F(JsonNumericArrayCodecTest, ToJson_Works)
+{
+    Telemetry telemetry;
+    telemetry.samples  = {0.5, -1.25, 1e300};
+    telemetry.counters = {1, -2, std::numeric_limits<std::int64_t>::max()};
+    telemetry.packed   = {1.0f};
+    telemetry.gains    = {1, 2, 3};
+    telemetry.offsets  = std::vector<std::uint16_t>{0x0102, 0xFFFF};
+
+    const auto j = telemetry.toJson();
+    EXPECT_EQ(j["samples"], nlohmann::json({0.5, -1.25, 1e300}));
+    EXPECT_EQ(j["counters"], nlohmann::json({1, -2, std::numeric_limits<std::int64_t>::max()}));
+    // 1.0f is 0x3F800000, little-endian
+    EXPECT_EQ(j["packed"], "AACAPw==");
+    EXPECT_EQ(j["gains"], nlohmann::json({1, 2, 3}));
+    EXPECT_EQ(j["offsets"], encode(std::string("\x02\x01\xff\xff", 4)));
+}
+
+TEST_F(JsonNumericArrayCodecTest, RefreshFromJson_Works)
+{
+    Telemetry source;
+    source.samples  = {0.1, 2.0 / 3.0, -0.0, std::numeric_limits<double>::max()};
+    source.counters = {std::numeric_limits<std::int64_t>::min(), 0};
+    source.packed   = {0.1f, -3.5f, std::numeric_limits<float>::denorm_min()};
+    source.gains    = {4, 5, 6};
+    source.offsets  = std::vector<std::uint16_t>{1, 65535};
+
+    Telemetry target;
+    target.samples.resize(100);
+    ASSERT_TRUE(target.refreshFromJson(nlohmann::json::parse(source.toJson().dump())));
+    EXPECT_EQ(target.samples, source.samples);
+    EXPECT_EQ(target.counters, source.counters);
+    EXPECT_EQ(target.packed, source.packed);
+    EXPECT_EQ(target.gains, source.gains);
+    EXPECT_EQ(target.offsets, source.offsets);
+    EXPECT_EQ(target, source);
+}
+
+TEST_F(JsonNumericArrayCodecTest, RefreshFromJson_DecodesInPlace)
+{
+    Telemetry telemetry;
+    telemetry.samples.reserve(8);
+    telemetry.samples = {1.0, 2.0};
+    const auto* samples = telemetry.samples.data();
+
+    ASSERT_TRUE(telemetry.refreshFromJson(
+        R"({"samples": [3.0, 4.0, 5.0], "counters": [], "packed": "AACAPw==", "gains": [1, 2, 3]})"_json));
+    EXPECT_EQ(telemetry.samples, std::vector<double>({3.0, 4.0, 5.0}));
+    EXPECT_EQ(telemetry.samples.data(), samples);
+    EXPECT_EQ(telemetry.samples.capacity(), 8u);
+}
+
+TEST_F(JsonNumericArrayCodecTest, RefreshFromJson_ConvertsLikeNlohmannJson)
+{
+    Telemetry telemetry;
+    ASSERT_TRUE(telemetry.refreshFromJson(
+        R"({"samples": [1, -2, 3.5, 18446744073709551615], "counters": [2.9, 3], "packed": "", "gains": [7, 8, 9, 10]})"_json));
+    EXPECT_EQ(telemetry.samples, std::vector<double>({1.0, -2.0, 3.5, 18446744073709551615.0}));
+    EXPECT_EQ(telemetry.counters, std::vector<std::int64_t>({2, 3}));
+    EXPECT_TRUE(telemetry.packed.empty());
+    // Extra elements of a std::array are ignored, as by nlohmann::json
+    EXPECT_EQ(telemetry.gains, (std::array<int, 3>{7, 8, 9}));
+}
+
+TEST_F(JsonNumericArrayCodecTest, RefreshFromJson_ChecksEncoding)
+{
+    Telemetry telemetry;
+    EXPECT_FALSE(telemetry.refreshFromJson(R"({"samples": [], "counters": [], "packed": [1.0], "gains": [1, 2, 3]})"_json));
+    // Not a multiple of sizeof(float)
+    EXPECT_FALSE(telemetry.refreshFromJson(R"({"samples": [], "counters": [], "packed": "AAAA", "gains": [1, 2, 3]})"_json));
+    EXPECT_FALSE(telemetry.refreshFromJson(R"({"samples": [], "counters": [], "packed": "AA!AAA==", "gains": [1, 2, 3]})"_json));
+    // Invalid optional values are ignored
+    EXPECT_TRUE(telemetry.refreshFromJson(
+        R"({"samples": [], "counters": [], "packed": "AACAPw==", "gains": [1, 2, 3], "offsets": "A"})"_json));
+}
+
+TEST_F(JsonNumericArrayCodecTest, RefreshFromJson_KeepsValuesOnError)
+{
+    Telemetry telemetry;
+    telemetry.samples = {1.0, 2.0};
+    telemetry.packed  = {5.0f};
+    telemetry.gains   = {1, 2, 3};
+
+    // The third float has an invalid character, after the first two were decoded
+    EXPECT_FALSE(telemetry.refreshFromJson(
+        R"({"samples": [1.0, 2.0], "counters": [], "packed": "AACAPwAAAEAAAEB!", "gains": [1, 2, 3]})"_json));
+    EXPECT_EQ(telemetry.packed, std::vector<float>({5.0f}));
+
+    EXPECT_ANY_THROW(telemetry.refreshFromJson(
+        R"({"samples": [4.0, "x", 6.0], "counters": [], "packed": "", "gains": [1, 2, 3]})"_json));
+    EXPECT_EQ(telemetry.samples, std::vector<double>({1.0, 2.0}));
+
+    EXPECT_ANY_THROW(telemetry.refreshFromJson(
+        R"({"samples": [], "counters": [], "packed": "", "gains": [4, "x", 6]})"_json));
+    EXPECT_EQ(telemetry.gains, (std::array<int, 3>{1, 2, 3}));
+}
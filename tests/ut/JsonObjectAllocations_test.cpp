@@ -0,0 +1,174 @@
+#include "AllocationCounter.hpp"
+#include "JsonObjectConverter.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+using namespace ::testing;
+using namespace joc;
+using namespace joc::test;
+
+namespace
+{
+
+/**
+ * Allocation budgets of the conversion paths (see AllocationBudget). The bytes are
+ * relative to copying the JSON value of the sample.
+ */
+struct ConversionBudget
+{
+    AllocationBudget toJson;
+    AllocationBudget refreshFromJson;
+    AllocationBudget copy;
+    // Destruction never allocates
+};
+
+struct ConversionStats
+{
+    AllocationStats baseline;
+    AllocationStats toJson;
+    AllocationStats refreshFromJson;
+    AllocationStats copy;
+    AllocationStats destruction;
+};
+
+/**
+ * @return the heap activity of copying json, the baseline of the budgets: the bytes
+ *         of the values it holds, with the types of the platform
+ */
+template<typename Json>
+AllocationStats measureJsonCopy(const Json& json)
+{
+    return measureAllocations([&json]() { const Json copy(json); });
+}
+
+template<typename T>
+ConversionStats measureConversions(const T& sample)
+{
+    ConversionStats stats;
+    const auto json = sample.toJson();
+
+    stats.baseline = measureJsonCopy(json);
+    stats.toJson = measureAllocations([&sample]() { sample.toJson(); });
+
+    // One-time initializations (e.g. function-local statics) are not part of the budget
+    T().refreshFromJson(json);
+
+    T target;
+    stats.refreshFromJson = measureAllocations([&target, &json]() { target.refreshFromJson(json); });
+
+    std::optional<T> copy;
+    stats.copy        = measureAllocations([&copy, &sample]() { copy.emplace(sample); });
+    stats.destruction = measureAllocations([&copy]() { copy.reset(); });
+
+    return stats;
+}
+
+void report(const std::string& name, const ConversionStats& stats)
+{
+    const auto line = [&stats](const AllocationStats& operation) {
+        std::ostringstream os;
+        os << operation << ", " << bytesPercent(operation, stats.baseline) << "% of the baseline bytes";
+        return os.str();
+    };
+    std::cout << name << '\n'
+              << "  baseline:        " << stats.baseline << '\n'
+              << "  toJson:          " << line(stats.toJson) << '\n'
+              << "  refreshFromJson: " << line(stats.refreshFromJson) << '\n'
+              << "  copy:            " << line(stats.copy) << '\n'
+              << "  destruction:     " << line(stats.destruction) << std::endl;
+}
+
+void expectWithinBudget(const ConversionStats& stats, const ConversionBudget& budget)
+{
+    EXPECT_TRUE(isWithinBudget(stats.toJson, budget.toJson, stats.baseline))
+        << "toJson: " << stats.toJson << ", " << budget.toJson;
+    EXPECT_TRUE(isWithinBudget(stats.refreshFromJson, budget.refreshFromJson, stats.baseline))
+        << "refreshFromJson: " << stats.refreshFromJson << ", " << budget.refreshFromJson;
+    EXPECT_TRUE(isWithinBudget(stats.copy, budget.copy, stats.baseline))
+        << "copy: " << stats.copy << ", " << budget.copy;
+    EXPECT_TRUE(isAllocationFree(stats.destruction)) << "destruction: " << stats.destruction;
+}
+
+TestStruct makeTestStruct(int i)
+{
+    TestStruct t;
+    t.a = i;
+    t.b = "a string too long for small string optimization " + std::to_string(i);
+    t.c = i * 0.5;
+    return t;
+}
+
+Contact makeContact(const std::string& name, int age)
+{
+    Contact c;
+    c.name    = name;
+    c.address = "Rua das Amendoas 4, 1000-001 Lisboa";
+    c.age     = age;
+    c.email   = name + "@hisspace.com";
+    c.type    = ContactType::Friend;
+    return c;
+}
+
+} // namespace
+
+struct JsonObjectAllocationsTest : public Test
+{
+};
+
+TEST_F(JsonObjectAllocationsTest, Counter_Works)
+{
+    const auto stats = measureAllocations([]() {
+        void* small = ::operator new(sizeof(int));
+        void* large = ::operator new(100);
+        ::operator delete(small);
+        ::operator delete(large);
+    });
+    EXPECT_EQ(stats.allocations, 2);
+    EXPECT_EQ(stats.deallocations, 2);
+    EXPECT_EQ(stats.bytes, sizeof(int) + 100);
+
+    const AllocationStats baseline{1, 1, 2 * (sizeof(int) + 100)};
+    EXPECT_EQ(bytesPercent(stats, baseline), 50);
+    EXPECT_TRUE(isWithinBudget(stats, {2, 50}, baseline));
+    EXPECT_FALSE(isWithinBudget(stats, {1, 100}, baseline));
+    EXPECT_FALSE(isWithinBudget(stats, {2, 40}, baseline));
+    EXPECT_FALSE(isAllocationFree(stats));
+    EXPECT_TRUE(isAllocationFree(measureAllocations([]() {})));
+}
+
+TEST_F(JsonObjectAllocationsTest, TestStruct_WithinBudget)
+{
+    const auto stats = measureConversions(makeTestStruct(1));
+    report("TestStruct", stats);
+    expectWithinBudget(stats, {{9, 120}, {1, 12}, {2, 145}});
+}
+
+TEST_F(JsonObjectAllocationsTest, TestStructWithList_WithinBudget)
+{
+    TestStructWithList sample;
+    for (int i = 0; i < 10; ++i)
+    {
+        sample.list.push_back(makeTestStruct(i));
+    }
+
+    const auto stats = measureConversions(sample);
+    report("TestStructWithList (10 elements)", stats);
+    expectWithinBudget(stats, {{153, 215}, {40, 290}, {31, 172}});
+}
+
+TEST_F(JsonObjectAllocationsTest, ContactBook_WithinBudget)
+{
+    ContactBook sample;
+    sample.owner       = "Ricardo";
+    sample.contactList = {makeContact("Mary", 52), makeContact("Peter", 34), makeContact("Joana", 27)};
+
+    const auto stats = measureConversions(sample);
+    report("ContactBook (3 contacts)", stats);
+    expectWithinBudget(stats, {{105, 219}, {21, 271}, {13, 163}});
+}
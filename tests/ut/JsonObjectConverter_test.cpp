@@ -1,4 +1,6 @@
+#include "AllocationCounter.hpp"
 #include "JsonObjectConverter.hpp"
+#include "TestTypes.hpp"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -8,29 +10,9 @@
 
 using namespace ::testing;
 using namespace joc;
+using namespace joc::test;
 using namespace std::chrono;
 
-struct TestStruct : public JsonObject
-{
-    TestStruct()
-        : JsonObject({
-            {"a", a},
-            {"b", b},
-            {"c", c},
-        }){};
-    int a{0};
-    std::string b{"default"};
-    std::optional<double> c;
-};
-
-struct TestStructWithList : public JsonObject
-{
-    TestStructWithList()
-        : JsonObject({{"my_list", list}}){};
-
-    std::list<TestStruct> list;
-};
-
 struct JsonObjectTest : public Test
 {
 };
@@ -270,6 +252,92 @@ TEST_F(JsonObjectTest, NestedJsonConvertersAsOptional_Works)
     EXPECT_EQ(h.toJson().dump(), R"({"tree":{"fruits":700}})");
 }
 
+TEST_F(JsonObjectTest, RefreshListInPlace_ResetsReusedElements)
+{
+    TestStructWithList myStruct;
+    ASSERT_TRUE(myStruct.refreshFromJson(R"({"my_list":[{"a":1,"b":"T1","c":1.5},{"a":2,"b":"T2"}]})"_json));
+    const auto* first = &myStruct.list.front();
+
+    ASSERT_TRUE(myStruct.refreshFromJson(R"({"my_list":[{"a":3,"b":"T3"}]})"_json));
+    ASSERT_EQ(myStruct.list.size(), 1);
+    EXPECT_EQ(&myStruct.list.front(), first);
+    EXPECT_EQ(myStruct.list.front().a, 3);
+    EXPECT_EQ(myStruct.list.front().c, std::nullopt);
+
+    ASSERT_TRUE(myStruct.refreshFromJson(R"({"my_list":[]})"_json));
+    EXPECT_TRUE(myStruct.list.empty());
+}
+
+TEST_F(JsonObjectTest, UnknownKeys_DroppedByDefault)
+{
+    TestStruct t;
+    EXPECT_FALSE(t.keepsUnknownKeys());
+    ASSERT_TRUE(t.refreshFromJson(R"({"a":1,"b":"T1","extra":true})"_json));
+
+    EXPECT_TRUE(t.getUnknownKeys().is_null());
+    EXPECT_EQ(t.toJson().dump(), R"({"a":1,"b":"T1"})");
+}
+
+TEST_F(JsonObjectTest, UnknownKeys_PassThrough)
+{
+    const auto message = R"({"a":1,"b":"T1","extra":{"list":[1,2]},"z":null})"_json;
+
+    TestStruct t;
+    t.setKeepUnknownKeys(true);
+    ASSERT_TRUE(t.refreshFromJson(message));
+    EXPECT_EQ(t.getUnknownKeys(), R"({"extra":{"list":[1,2]},"z":null})"_json);
+
+    t.a = 2;
+    EXPECT_EQ(t.toJson(), R"({"a":2,"b":"T1","extra":{"list":[1,2]},"z":null})"_json);
+
+    // Copies keep the setting and the keys, comparisons take the keys into account
+    TestStruct copy = t;
+    EXPECT_TRUE(copy.keepsUnknownKeys());
+    EXPECT_EQ(copy, t);
+    EXPECT_EQ(copy.fingerprint(), t.fingerprint());
+
+    TestStruct assigned;
+    assigned = t;
+    EXPECT_TRUE(assigned.keepsUnknownKeys());
+    EXPECT_EQ(assigned.toJson(), t.toJson());
+    EXPECT_EQ(assigned, t);
+
+    assigned = TestStruct();
+    EXPECT_FALSE(assigned.keepsUnknownKeys());
+    EXPECT_TRUE(assigned.getUnknownKeys().is_null());
+
+    copy.clearUnknownKeys();
+    EXPECT_NE(copy, t);
+    EXPECT_NE(copy.fingerprint(), t.fingerprint());
+    EXPECT_EQ(copy.toJson().dump(), R"({"a":2,"b":"T1"})");
+
+    // Replaced on each refresh
+    ASSERT_TRUE(t.refreshFromJson(R"({"a":3,"b":"T3","other":1})"_json));
+    EXPECT_EQ(t.getUnknownKeys(), R"({"other":1})"_json);
+    ASSERT_TRUE(t.refreshFromJson(R"({"a":3,"b":"T3"})"_json));
+    EXPECT_TRUE(t.getUnknownKeys().is_null());
+}
+
+TEST_F(JsonObjectTest, UnknownKeys_KeptInNestedObjects)
+{
+    const auto message =
+        R"({"owner":"Ricardo","version":2,"contact_list":[{"type":"Friend","name":"Mary","address":"Lisboa","age":52,"nickname":"M"}]})"_json;
+
+    ContactBook book;
+    book.setKeepUnknownKeys(true);
+    ASSERT_TRUE(book.refreshFromJson(message));
+    ASSERT_EQ(book.contactList.size(), 1);
+    EXPECT_FALSE(book.contactList.front().keepsUnknownKeys());
+    EXPECT_EQ(book.contactList.front().getUnknownKeys(), R"({"nickname":"M"})"_json);
+    EXPECT_EQ(book.toJson(), message);
+
+    // Dropped by the next refresh of an object that does not keep them
+    book.setKeepUnknownKeys(false);
+    ASSERT_TRUE(book.refreshFromJson(message));
+    EXPECT_TRUE(book.getUnknownKeys().is_null());
+    EXPECT_TRUE(book.contactList.front().getUnknownKeys().is_null());
+}
+
 TEST_F(JsonObjectTest, MapsConvertedToJsonObjects_Works)
 {
     struct TestStructWithMap : public JsonObject
@@ -317,3 +385,275 @@ TEST_F(JsonObjectTest, Copies_Work)
     EXPECT_EQ(t.b, "T1");
     EXPECT_EQ(t.c, std::nullopt);
 }
+
+TEST_F(JsonObjectTest, GetByKey_Works)
+{
+    TestStruct t;
+    t.a = 5;
+    t.c = 1.5;
+
+    ASSERT_NE(t.get<int>("a"), nullptr);
+    EXPECT_EQ(*t.get<int>("a"), 5);
+    EXPECT_EQ(t.get<int>("a"), &t.a);
+    EXPECT_EQ(*t.get<std::string>("b"), "default");
+    EXPECT_EQ(*t.get<std::optional<double>>("c"), 1.5);
+
+    // Unknown keys and wrong types
+    EXPECT_EQ(t.get<int>("d"), nullptr);
+    EXPECT_EQ(t.get<double>("a"), nullptr);
+    EXPECT_EQ(t.get<double>("c"), nullptr);
+
+    *t.get<int>("a") = 7;
+    EXPECT_EQ(t.a, 7);
+
+    const TestStruct& constRef = t;
+    EXPECT_EQ(*constRef.get<int>("a"), 7);
+}
+
+TEST_F(JsonObjectTest, GetByIndex_Works)
+{
+    const auto index = TestStruct().fieldIndex("b");
+    ASSERT_TRUE(index.has_value());
+    EXPECT_FALSE(TestStruct().fieldIndex("z").has_value());
+
+    std::vector<TestStruct> structs(3);
+    structs[1].b = "second";
+    EXPECT_EQ(*structs[0].get<std::string>(*index), "default");
+    EXPECT_EQ(*structs[1].get<std::string>(*index), "second");
+    EXPECT_EQ(structs[1].get<int>(*index), nullptr);
+    EXPECT_EQ(structs[1].get<int>(100), nullptr);
+}
+
+TEST_F(JsonObjectTest, GetAfterCopy_PointsToCopy)
+{
+    TestStruct t;
+    t.get<int>("a"); // sets the key index of the class, copied with the object
+
+    TestStruct copy = t;
+    EXPECT_EQ(copy.get<int>("a"), &copy.a);
+    EXPECT_EQ(copy.get<std::string>("b"), &copy.b);
+}
+
+TEST_F(JsonObjectTest, GetOnPlainJsonObjects_UsesTheirKeys)
+{
+    int a{1};
+    std::string b{"b"};
+    JsonObject first({{"a", a}, {"b", b}});
+    JsonObject second({{"b", b}});
+
+    EXPECT_EQ(first.fieldIndex("b"), 1u);
+    EXPECT_EQ(second.fieldIndex("b"), 0u);
+    EXPECT_FALSE(second.fieldIndex("a").has_value());
+    EXPECT_EQ(JsonObject({{"a", a}, {"b", b}}).fieldIndex("b"), 1u);
+    EXPECT_EQ(second.get<std::string>("b"), &b);
+}
+
+namespace
+{
+struct Record : public JsonObject
+{
+    // The name is only a field of named records
+    explicit Record(bool named)
+        : JsonObject(named ? std::vector<JsonPair>{{"name", name}, {"id", id}} : std::vector<JsonPair>{{"id", id}}){};
+
+    std::string name{"record"};
+    int id{0};
+};
+
+struct Timeline : public JsonObject
+{
+    Timeline()
+        : JsonObject({{"times", times}}){};
+
+    std::vector<SystemTimePoint> times;
+};
+} // namespace
+
+TEST_F(JsonObjectTest, ListElementErrors_FailTheField)
+{
+    Timeline timeline;
+    EXPECT_TRUE(timeline.refreshFromJson(R"({"times": [1, 2]})"_json));
+    EXPECT_FALSE(timeline.refreshFromJson(R"({"times": [3, "not a timestamp"]})"_json));
+    ASSERT_EQ(timeline.times.size(), 2);
+    EXPECT_EQ(timeline.times.front(), SystemTimePoint(seconds(3)));
+
+    ContactBook book;
+    EXPECT_FALSE(book.refreshFromJson(
+        R"({"owner": "Ricardo", "contact_list": [{"type": "Friend", "address": "Lisboa", "age": 52}]})"_json));
+}
+
+TEST_F(JsonObjectTest, GetOnObjectsWithConstructorDependentKeys_UsesTheirKeys)
+{
+    Record named(true);
+    named.id = 1;
+    Record anonymous(false);
+    anonymous.id = 2;
+
+    EXPECT_EQ(named.fieldIndex("id"), 1u);
+    EXPECT_EQ(anonymous.fieldIndex("id"), 0u);
+    EXPECT_FALSE(anonymous.fieldIndex("name").has_value());
+    EXPECT_EQ(anonymous.get<int>("id"), &anonymous.id);
+    EXPECT_TRUE(anonymous.set("id", 3));
+    EXPECT_EQ(anonymous.id, 3);
+    EXPECT_EQ(Record(true).fieldIndex("id"), 1u);
+    EXPECT_EQ(Record(false).fieldIndex("id"), 0u);
+    EXPECT_EQ(Record(anonymous).fieldIndex("id"), 0u);
+}
+
+TEST_F(JsonObjectTest, Set_Works)
+{
+    std::mutex mutex;
+    TestStruct t;
+    t.setDataMutex(&mutex);
+
+    EXPECT_TRUE(t.set("a", 10));
+    EXPECT_EQ(t.a, 10);
+    EXPECT_TRUE(t.set<std::string>("b", "new"));
+    EXPECT_EQ(t.b, "new");
+    EXPECT_TRUE(t.set("c", std::optional<double>(2.5)));
+    EXPECT_EQ(t.c, 2.5);
+
+    EXPECT_FALSE(t.set("b", 10));
+    EXPECT_FALSE(t.set("z", 10));
+    EXPECT_EQ(t.toJson().dump(), R"({"a":10,"b":"new","c":2.5})");
+}
+
+TEST_F(JsonObjectTest, VisitFields_Works)
+{
+    TestStruct t;
+    t.a = 3;
+
+    std::vector<std::string> keys;
+    int sum = 0;
+    t.visitFields([&](const JsonPair& pair) {
+        keys.push_back(pair.getName());
+        if (const auto* value = pair.getIf<int>())
+        {
+            sum += *value;
+        }
+    });
+    EXPECT_THAT(keys, ElementsAre("a", "b", "c"));
+    EXPECT_EQ(sum, 3);
+}
+
+TEST_F(JsonObjectTest, GetByPointer_Works)
+{
+    struct Tree : public JsonObject
+    {
+        Tree()
+            : JsonObject({{"fruits", fruits}}){};
+        int fruits{0};
+    };
+
+    struct House : public JsonObject
+    {
+        House()
+            : JsonObject({{"tree", tree}, {"back/yard", backyard}, {"rooms", rooms}, {"things", things}}){};
+        Tree tree;
+        std::optional<Tree> backyard;
+        std::map<std::string, TestStruct> rooms;
+        std::vector<TestStructWithList> things;
+    };
+
+    struct Street : public JsonObject
+    {
+        Street()
+            : JsonObject({{"houses", houses}}){};
+        std::map<std::string, House, std::less<>> houses;
+    };
+
+    House h;
+    h.tree.fruits = 5;
+    h.rooms["kitchen"].a = 8;
+    h.things.resize(2);
+    h.things[1].list.resize(3);
+    std::next(h.things[1].list.begin(), 2)->b = "deep";
+
+    EXPECT_EQ(*h.getByPointer<int>("/tree/fruits"), 5);
+    EXPECT_EQ(*h.getByPointer<int>("/rooms/kitchen/a"), 8);
+    EXPECT_EQ(*h.getByPointer<std::string>("/things/1/my_list/2/b"), "deep");
+    EXPECT_EQ(h.getByPointer<Tree>("/tree"), &h.tree);
+
+    // Escaped key, and empty optional
+    EXPECT_EQ(h.getByPointer<int>("/back~1yard/fruits"), nullptr);
+    h.backyard = Tree();
+    EXPECT_EQ(h.getByPointer<int>("/back~1yard/fruits"), &h.backyard->fruits);
+
+    EXPECT_EQ(h.getByPointer<int>(""), nullptr);
+    EXPECT_EQ(h.getByPointer<int>("tree/fruits"), nullptr);
+    EXPECT_EQ(h.getByPointer<int>("/tree/leaves"), nullptr);
+    EXPECT_EQ(h.getByPointer<int>("/tree/fruits/0"), nullptr);
+    EXPECT_EQ(h.getByPointer<int>("/rooms/bedroom/a"), nullptr);
+    EXPECT_EQ(h.getByPointer<std::string>("/things/2/my_list/0/b"), nullptr);
+    EXPECT_EQ(h.getByPointer<std::string>("/things/x/my_list/0/b"), nullptr);
+    EXPECT_EQ(h.getByPointer<TestStructWithList>("/things/1"), nullptr);
+
+    // Maps with a transparent comparator are looked up with the token itself
+    Street street;
+    street.houses["a house name too long for small string optimization"] = h;
+    EXPECT_EQ(*street.getByPointer<int>("/houses/a house name too long for small string optimization/tree/fruits"), 5);
+    EXPECT_EQ(street.getByPointer<int>("/houses/other/tree/fruits"), nullptr);
+}
+
+TEST_F(JsonObjectTest, FieldAccess_IsAllocationFree)
+{
+    ContactBook book;
+    book.contactList.resize(2);
+    std::vector<Contact> contacts(1000);
+    std::vector<Contact> moreContacts(1000);
+
+    // The first access builds the key index of the classes, unless another test did
+    const auto firstStats = measureAllocations([&book, &contacts]() {
+        book.get<std::string>("owner");
+        book.getByPointer<int>("/contact_list/1/age");
+        for (auto& contact : contacts)
+        {
+            contact.get<int>("age");
+        }
+    });
+    const auto stats = measureAllocations([&book, &moreContacts]() {
+        book.get<std::string>("owner");
+        book.set<std::string>("owner", "Ricardo");
+        book.getByPointer<int>("/contact_list/1/age");
+        for (auto& contact : moreContacts)
+        {
+            contact.get<int>("age");
+        }
+    });
+    // The key indexes are built once per class, not per object
+    EXPECT_LT(firstStats.allocations, contacts.size()) << firstStats;
+    EXPECT_TRUE(isAllocationFree(stats)) << stats;
+}
+
+TEST_F(JsonObjectTest, UnknownKeys_KeepingIsFreeWithoutUnknownKeys)
+{
+    TestStruct sample;
+    sample.b = "a string too long for small string optimization";
+    const auto json = sample.toJson();
+
+    std::vector<TestStruct> dropping(100);
+    std::vector<TestStruct> keeping(100);
+    for (auto& t : keeping)
+    {
+        t.setKeepUnknownKeys(true);
+    }
+    // The key index of the class is built once per process, by any of its objects
+    TestStruct warmUp;
+    warmUp.setKeepUnknownKeys(true);
+    warmUp.refreshFromJson(json);
+
+    const auto droppingStats = measureAllocations([&]() {
+        for (auto& t : dropping)
+        {
+            t.refreshFromJson(json);
+        }
+    });
+    const auto keepingStats = measureAllocations([&]() {
+        for (auto& t : keeping)
+        {
+            t.refreshFromJson(json);
+        }
+    });
+    EXPECT_EQ(keepingStats.allocations, droppingStats.allocations) << keepingStats << ", " << droppingStats;
+    EXPECT_EQ(keepingStats.bytes, droppingStats.bytes) << keepingStats << ", " << droppingStats;
+}
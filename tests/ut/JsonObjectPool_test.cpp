@@ -0,0 +1,140 @@
+#include "AllocationCounter.hpp"
+#include "JsonObjectPool.hpp"
+#include "TestTypes.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <thread>
+
+using namespace ::testing;
+using namespace joc;
+using namespace joc::test;
+
+struct JsonObjectPoolTest : public Test
+{
+};
+
+TEST_F(JsonObjectPoolTest, Acquire_RecyclesResetObjects)
+{
+    JsonObjectPool<TestStruct> pool;
+
+    TestStruct* first = nullptr;
+    {
+        auto handle = pool.acquire();
+        ASSERT_TRUE(handle);
+        ASSERT_TRUE(handle->refreshFromJson(R"({"a":1,"b":"a string too long for small string optimization","c":2.5})"_json));
+        first = handle.get();
+        EXPECT_EQ(pool.idle(), 0);
+    }
+    EXPECT_EQ(pool.idle(), 1);
+
+    auto handle = pool.acquire();
+    EXPECT_EQ(handle.get(), first);
+    EXPECT_EQ(handle->toJson(), TestStruct().toJson());
+    EXPECT_GE(handle->b.capacity(), std::string("a string too long for small string optimization").size());
+}
+
+TEST_F(JsonObjectPoolTest, RecycledObject_Works)
+{
+    JsonObjectPool<ContactBook> pool;
+    pool.acquire()->refreshFromJson(R"({"owner":"Ricardo","contact_list":[{"name":"Mary","age":52}]})"_json);
+
+    // Reset to the default values
+    auto book = pool.acquire();
+    EXPECT_EQ(*book, ContactBook());
+    EXPECT_TRUE(book->contactList.empty());
+    ASSERT_TRUE(book->refreshFromJson(
+        R"({"owner":"Ricardo","contact_list":[{"type":"Work","name":"Peter","address":"","age":34,"e-mail":"peter@hisspace.com"},{"type":"Friend","name":"Joana","address":"","age":27}]})"_json));
+    ASSERT_EQ(book->contactList.size(), 2);
+    EXPECT_EQ(book->contactList.front().name, "Peter");
+    EXPECT_EQ(book->contactList.back().email, std::nullopt);
+
+    // Copies of recycled objects are independent
+    const ContactBook copy = *book;
+    book->contactList.front().age = 35;
+    EXPECT_EQ(copy.contactList.front().age, 34);
+}
+
+TEST_F(JsonObjectPoolTest, Handle_MoveAndReset_Work)
+{
+    JsonObjectPool<TestStruct> pool;
+
+    auto handle = pool.acquire();
+    auto* object = handle.get();
+    auto moved   = std::move(handle);
+    EXPECT_FALSE(handle);
+    EXPECT_EQ(moved.get(), object);
+    EXPECT_EQ(pool.idle(), 0);
+
+    moved.reset();
+    EXPECT_FALSE(moved);
+    EXPECT_EQ(pool.idle(), 1);
+
+    handle = pool.acquire();
+    moved  = pool.acquire();
+    moved  = std::move(handle);
+    EXPECT_EQ(pool.idle(), 1);
+}
+
+TEST_F(JsonObjectPoolTest, MaxIdle_Works)
+{
+    JsonObjectPool<TestStruct> pool(2);
+    pool.reserve(5);
+    EXPECT_EQ(pool.idle(), 2);
+
+    {
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        auto c = pool.acquire();
+        EXPECT_EQ(pool.idle(), 0);
+    }
+    EXPECT_EQ(pool.idle(), 2);
+}
+
+TEST_F(JsonObjectPoolTest, ThreadLocal_IsPerThread)
+{
+    auto& pool = JsonObjectPool<TestStruct>::threadLocal();
+    EXPECT_EQ(&pool, &JsonObjectPool<TestStruct>::threadLocal());
+
+    JsonObjectPool<TestStruct>* otherPool = nullptr;
+    std::thread([&otherPool]() {
+        otherPool = &JsonObjectPool<TestStruct>::threadLocal();
+        auto handle = otherPool->acquire();
+        handle->a   = 1;
+    }).join();
+    EXPECT_NE(otherPool, &pool);
+}
+
+TEST_F(JsonObjectPoolTest, RecycledObject_AllocatesLess)
+{
+    JsonObjectPool<TestStruct> testStructPool;
+    JsonObjectPool<ContactBook> bookPool;
+
+    TestStruct testStruct;
+    testStruct.b              = "a string too long for small string optimization";
+    const auto testStructJson = testStruct.toJson();
+
+    ContactBook book;
+    book.owner = "Ricardo";
+    book.contactList.resize(3);
+    for (auto& contact : book.contactList)
+    {
+        contact.address = "Rua das Amendoas 4, 1000-001 Lisboa";
+    }
+    const auto bookJson = book.toJson();
+
+    const auto convertTestStruct = [&]() { testStructPool.acquire()->refreshFromJson(testStructJson); };
+    const auto convertBook       = [&]() { bookPool.acquire()->refreshFromJson(bookJson); };
+    // The first conversions construct the objects and grow their strings
+    convertTestStruct();
+    convertBook();
+
+    const auto testStructStats = measureAllocations(convertTestStruct);
+    const auto bookStats       = measureAllocations(convertBook);
+    const auto newBookStats    = measureAllocations([&]() { ContactBook().refreshFromJson(bookJson); });
+
+    EXPECT_TRUE(isAllocationFree(testStructStats)) << testStructStats;
+    // The containers are cleared by the reset, their elements are constructed again
+    EXPECT_LT(bookStats.allocations, newBookStats.allocations) << bookStats << ", " << newBookStats;
+}
@@ -0,0 +1,200 @@
+#include "JsonObjectConverter.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ::testing;
+using namespace joc;
+
+namespace
+{
+struct Status : public JsonObject
+{
+    Status()
+        : JsonObject({{"state", state}, {"sequence", sequence}, {"checksum", checksum}}){};
+
+    std::string state{"idle"};
+    int sequence{0};
+    int checksum{0};
+};
+
+/**
+ * Calls onAssign when assigned, to read the object while its assignment runs
+ */
+struct AssignmentProbe
+{
+    AssignmentProbe() = default;
+    AssignmentProbe(const AssignmentProbe&) = default;
+    AssignmentProbe& operator=(const AssignmentProbe&)
+    {
+        if (onAssign)
+        {
+            onAssign();
+        }
+        return *this;
+    }
+
+    std::function<void()> onAssign;
+};
+
+struct ProbedStatus : public JsonObject
+{
+    ProbedStatus()
+        : JsonObject({{"state", state}}){};
+
+    // Assigned before the fields by the implicit assignment
+    AssignmentProbe probe;
+    std::string state{"idle"};
+};
+} // namespace
+
+struct JsonSerializationCacheTest : public Test
+{
+};
+
+TEST_F(JsonSerializationCacheTest, Disabled_ConvertsEachTime)
+{
+    Status status;
+    EXPECT_FALSE(status.hasSerializationCache());
+
+    const auto first  = status.cachedDump();
+    const auto second = status.cachedDump();
+    EXPECT_EQ(*first, status.toJson().dump());
+    EXPECT_NE(first, second);
+    EXPECT_EQ(*status.cachedJson(), status.toJson());
+
+    status.invalidate();
+    EXPECT_EQ(status.generation(), 0);
+    EXPECT_EQ(status.serializationCacheStats().hits, 0);
+    EXPECT_EQ(status.serializationCacheStats().misses, 0);
+}
+
+TEST_F(JsonSerializationCacheTest, Enabled_ReusesUntilChanged)
+{
+    Status status;
+    status.setSerializationCache(true);
+
+    const auto first = status.cachedDump();
+    EXPECT_EQ(*first, status.toJson().dump());
+    EXPECT_EQ(status.cachedDump(), first);
+    EXPECT_EQ(*status.cachedJson(), status.toJson());
+    EXPECT_EQ(status.serializationCacheStats().hits, 2);
+    EXPECT_EQ(status.serializationCacheStats().misses, 1);
+
+    ASSERT_TRUE(status.refreshFromJson(R"({"state": "running", "sequence": 1, "checksum": 1})"_json));
+    EXPECT_EQ(status.generation(), 1);
+    const auto refreshed = status.cachedDump();
+    EXPECT_NE(refreshed, first);
+    EXPECT_EQ(*refreshed, R"({"checksum":1,"sequence":1,"state":"running"})");
+    // The previous buffer is unchanged
+    EXPECT_EQ(*first, R"({"checksum":0,"sequence":0,"state":"idle"})");
+
+    EXPECT_TRUE(status.set("state", std::string("stopped")));
+    EXPECT_EQ(status.cachedJson()->at("state"), "stopped");
+
+    // Direct changes are not counted until invalidate()
+    status.sequence = 2;
+    EXPECT_EQ(status.cachedJson()->at("sequence"), 1);
+    status.invalidate();
+    EXPECT_EQ(status.cachedJson()->at("sequence"), 2);
+
+    const Status other;
+    status = other;
+    EXPECT_EQ(*status.cachedDump(), other.toJson().dump());
+
+    status.setSerializationCache(false);
+    EXPECT_FALSE(status.hasSerializationCache());
+    EXPECT_EQ(status.serializationCacheStats().misses, 0);
+}
+
+TEST_F(JsonSerializationCacheTest, Copy_KeepsSettingOnly)
+{
+    Status status;
+    status.setSerializationCache(true);
+    status.cachedDump();
+
+    Status copy(status);
+    EXPECT_TRUE(copy.hasSerializationCache());
+    EXPECT_EQ(copy.serializationCacheStats().misses, 0);
+    copy.state = "copied";
+    EXPECT_EQ(copy.cachedJson()->at("state"), "copied");
+    EXPECT_EQ(status.cachedJson()->at("state"), "idle");
+}
+
+TEST_F(JsonSerializationCacheTest, Assignment_Invalidates)
+{
+    Status status;
+    status.setSerializationCache(true);
+    status.cachedDump();
+    const auto generation = status.generation();
+
+    Status running;
+    running.state = "running";
+    status        = running;
+    EXPECT_GT(status.generation(), generation);
+    EXPECT_EQ(status.cachedJson()->at("state"), "running");
+}
+
+TEST_F(JsonSerializationCacheTest, ReadDuringAssignment_NeedsInvalidate)
+{
+    ProbedStatus status;
+    status.setSerializationCache(true);
+    status.cachedDump();
+    status.probe.onAssign = [&status]() { status.cachedDump(); };
+
+    ProbedStatus running;
+    running.state = "running";
+    status        = running;
+    // Cached after the generation was incremented, before the fields were assigned
+    EXPECT_EQ(status.cachedJson()->at("state"), "idle");
+    status.invalidate();
+    EXPECT_EQ(status.cachedJson()->at("state"), "running");
+}
+
+TEST_F(JsonSerializationCacheTest, ConcurrentReaders_SeeConsistentSnapshots)
+{
+    std::mutex dataMutex;
+    Status status;
+    status.setDataMutex(&dataMutex);
+    status.setSerializationCache(true);
+
+    constexpr int UPDATES = 200;
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back([&]() {
+            while (!done)
+            {
+                const auto j = nlohmann::json::parse(*status.cachedDump());
+                if (j["sequence"] != j["checksum"])
+                {
+                    ++inconsistent;
+                }
+            }
+        });
+    }
+    for (int i = 1; i <= UPDATES; ++i)
+    {
+        status.refreshFromJson(nlohmann::json{{"state", "running"}, {"sequence", i}, {"checksum", i}});
+    }
+    done = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    EXPECT_EQ(inconsistent, 0);
+    EXPECT_EQ(status.cachedJson()->at("sequence"), UPDATES);
+    const auto stats = status.serializationCacheStats();
+    EXPECT_GT(stats.hits + stats.misses, 0);
+}
@@ -0,0 +1,166 @@
+#include "JsonObjectConverter.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using namespace ::testing;
+using namespace joc;
+using namespace std::chrono;
+
+namespace
+{
+std::string format(nanoseconds sinceEpoch)
+{
+    char buffer[kIso8601MaxLength];
+    return std::string(buffer, formatIso8601(sinceEpoch, buffer));
+}
+
+SystemTimePoint makeTimePoint(nanoseconds sinceEpoch)
+{
+    return SystemTimePoint(duration_cast<SystemClock::duration>(sinceEpoch));
+}
+
+// 2021-03-04T05:06:07Z
+constexpr seconds SAMPLE_SECONDS{1614834367};
+} // namespace
+
+struct JsonTimestampCodecTest : public Test
+{
+};
+
+TEST_F(JsonTimestampCodecTest, FormatIso8601_Works)
+{
+    EXPECT_EQ(format(nanoseconds(0)), "1970-01-01T00:00:00Z");
+    EXPECT_EQ(format(SAMPLE_SECONDS), "2021-03-04T05:06:07Z");
+    EXPECT_EQ(format(SAMPLE_SECONDS + milliseconds(120)), "2021-03-04T05:06:07.120Z");
+    EXPECT_EQ(format(SAMPLE_SECONDS + microseconds(123456)), "2021-03-04T05:06:07.123456Z");
+    EXPECT_EQ(format(SAMPLE_SECONDS + nanoseconds(1)), "2021-03-04T05:06:07.000000001Z");
+    EXPECT_EQ(format(nanoseconds(-1)), "1969-12-31T23:59:59.999999999Z");
+    EXPECT_EQ(format(hours(24 * 366 * 30)), "2000-01-24T00:00:00Z");
+    // Same day as the previous call, served from the date cache
+    EXPECT_EQ(format(hours(24 * 366 * 30) + hours(23)), "2000-01-24T23:00:00Z");
+}
+
+TEST_F(JsonTimestampCodecTest, ParseIso8601_Works)
+{
+    nanoseconds ns;
+    ASSERT_TRUE(parseIso8601("2021-03-04T05:06:07Z", ns));
+    EXPECT_EQ(ns, SAMPLE_SECONDS);
+    ASSERT_TRUE(parseIso8601("2021-03-04T05:06:07.123456789Z", ns));
+    EXPECT_EQ(ns, SAMPLE_SECONDS + nanoseconds(123456789));
+    ASSERT_TRUE(parseIso8601("2021-03-04t05:06:07.5z", ns));
+    EXPECT_EQ(ns, SAMPLE_SECONDS + milliseconds(500));
+    ASSERT_TRUE(parseIso8601("2021-03-04T07:36:07.1234567891+02:30", ns));
+    EXPECT_EQ(ns, SAMPLE_SECONDS + nanoseconds(123456789));
+    ASSERT_TRUE(parseIso8601("2021-03-04 00:06:07-05:00", ns));
+    EXPECT_EQ(ns, SAMPLE_SECONDS);
+    ASSERT_TRUE(parseIso8601("1969-12-31T23:59:59.999999999Z", ns));
+    EXPECT_EQ(ns, nanoseconds(-1));
+
+    EXPECT_FALSE(parseIso8601("", ns));
+    EXPECT_FALSE(parseIso8601("2021-03-04T05:06:07", ns));
+    EXPECT_FALSE(parseIso8601("2021-02-29T05:06:07Z", ns));
+    EXPECT_FALSE(parseIso8601("2021-13-04T05:06:07Z", ns));
+    EXPECT_FALSE(parseIso8601("2021-03-04T24:06:07Z", ns));
+    EXPECT_FALSE(parseIso8601("2021-03-04T05:06:07.Z", ns));
+    EXPECT_FALSE(parseIso8601("2021-03-04T05:06:07+0200", ns));
+    EXPECT_FALSE(parseIso8601("2021-03-04T05:06:07Zjunk", ns));
+    EXPECT_FALSE(parseIso8601("3021-03-04T05:06:07Z", ns));
+}
+
+TEST_F(JsonTimestampCodecTest, FormatParseRoundtrip_Works)
+{
+    for (auto ns = nanoseconds(-3'000'000'000'000'000'000); ns < nanoseconds(9'000'000'000'000'000'000);
+         ns += nanoseconds(987'654'321'987'654'321))
+    {
+        nanoseconds parsed;
+        ASSERT_TRUE(parseIso8601(format(ns), parsed)) << format(ns);
+        EXPECT_EQ(parsed, ns) << format(ns);
+    }
+}
+
+TEST_F(JsonTimestampCodecTest, DefaultTypeEncoding_IsEpochSeconds)
+{
+    struct Event : public JsonObject
+    {
+        Event()
+            : JsonObject({{"time", time}}){};
+        SystemTimePoint time;
+    };
+
+    Event e;
+    e.time = makeTimePoint(SAMPLE_SECONDS + milliseconds(999));
+    EXPECT_EQ(e.toJson().dump(), R"({"time":1614834367})");
+
+    EXPECT_TRUE(e.refreshFromJson(R"({"time":1614834368})"_json));
+    EXPECT_EQ(e.time.time_since_epoch(), SAMPLE_SECONDS + seconds(1));
+}
+
+TEST_F(JsonTimestampCodecTest, PerFieldEncoding_Works)
+{
+    struct Event : public JsonObject
+    {
+        Event()
+            : JsonObject({
+                {"s", s},
+                {"ms", ms, TimestampEncoding::EpochMilliseconds},
+                {"us", us, TimestampEncoding::EpochMicroseconds},
+                {"ns", ns, TimestampEncoding::EpochNanoseconds},
+                {"iso", iso, TimestampEncoding::Iso8601},
+                {"opt_iso", optIso, TimestampEncoding::Iso8601},
+            }){};
+        SystemTimePoint s;
+        SystemTimePoint ms;
+        SystemTimePoint us;
+        SystemTimePoint ns;
+        SystemTimePoint iso;
+        std::optional<SystemTimePoint> optIso;
+    };
+
+    const auto time = makeTimePoint(SAMPLE_SECONDS + nanoseconds(123456789));
+
+    Event e;
+    e.s = e.ms = e.us = e.ns = e.iso = time;
+    EXPECT_EQ(
+        e.toJson().dump(),
+        R"({"iso":"2021-03-04T05:06:07.123456789Z","ms":1614834367123,"ns":1614834367123456789,"s":1614834367,"us":1614834367123456})");
+
+    e.optIso = time;
+    EXPECT_EQ(e.toJson()["opt_iso"], "2021-03-04T05:06:07.123456789Z");
+
+    Event other;
+    EXPECT_TRUE(other.refreshFromJson(e.toJson()));
+    EXPECT_EQ(other.s.time_since_epoch(), SAMPLE_SECONDS);
+    EXPECT_EQ(other.ms.time_since_epoch(), SAMPLE_SECONDS + milliseconds(123));
+    EXPECT_EQ(other.us.time_since_epoch(), SAMPLE_SECONDS + microseconds(123456));
+    EXPECT_EQ(other.ns, time);
+    EXPECT_EQ(other.iso, time);
+    EXPECT_EQ(other.optIso, time);
+
+    auto json   = e.toJson();
+    json["iso"] = 5;
+    EXPECT_FALSE(other.refreshFromJson(json));
+    json["iso"] = "not a timestamp";
+    EXPECT_FALSE(other.refreshFromJson(json));
+
+    json["iso"]     = "2021-03-04T05:06:07Z";
+    json["opt_iso"] = nullptr;
+    EXPECT_TRUE(other.refreshFromJson(json));
+    EXPECT_EQ(other.iso.time_since_epoch(), SAMPLE_SECONDS);
+    EXPECT_EQ(other.optIso, std::nullopt);
+}
+
+TEST_F(JsonTimestampCodecTest, PerFieldEncoding_SurvivesCopy)
+{
+    struct Event : public JsonObject
+    {
+        Event()
+            : JsonObject({{"iso", iso, TimestampEncoding::Iso8601}}){};
+        SteadyTimePoint iso;
+    };
+
+    Event e;
+    e.iso      = SteadyTimePoint(SAMPLE_SECONDS);
+    Event copy = e;
+    EXPECT_EQ(copy.toJson().dump(), R"({"iso":"2021-03-04T05:06:07Z"})");
+}
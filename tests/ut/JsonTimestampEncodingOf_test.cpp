@@ -0,0 +1,76 @@
+#include "JsonObjectConverter.hpp"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+/**
+ * Per type selection of the timestamp encoding. The specialization follows the
+ * include of JsonObjectConverter.hpp, as in user code, and is the only one of
+ * this test executable (see TimestampEncodingOf).
+ */
+template<>
+struct joc::TimestampEncodingOf<joc::SystemTimePoint>
+{
+    static constexpr joc::TimestampEncoding value = joc::TimestampEncoding::Iso8601;
+};
+
+using namespace ::testing;
+using namespace joc;
+using namespace std::chrono;
+
+namespace
+{
+// 2021-03-04T05:06:07Z
+constexpr seconds SAMPLE_SECONDS{1614834367};
+
+struct Event : public JsonObject
+{
+    Event()
+        : JsonObject({
+            {"created", created},
+            {"updated", updated},
+            {"started", started},
+            {"s", s, TimestampEncoding::EpochSeconds},
+        }){};
+    SystemTimePoint created;
+    std::optional<SystemTimePoint> updated;
+    SteadyTimePoint started;
+    SystemTimePoint s;
+};
+} // namespace
+
+struct JsonTimestampEncodingOfTest : public Test
+{
+};
+
+TEST_F(JsonTimestampEncodingOfTest, SpecializedType_UsesItsEncoding)
+{
+    Event e;
+    e.created = SystemTimePoint(SAMPLE_SECONDS + milliseconds(500));
+    e.updated = SystemTimePoint(SAMPLE_SECONDS);
+    e.started = SteadyTimePoint(SAMPLE_SECONDS);
+    e.s       = SystemTimePoint(SAMPLE_SECONDS);
+
+    // SteadyTimePoint keeps the default, the per field encoding overrides the type one
+    EXPECT_EQ(
+        e.toJson().dump(),
+        R"({"created":"2021-03-04T05:06:07.500Z","s":1614834367,"started":1614834367,"updated":"2021-03-04T05:06:07Z"})");
+
+    Event other;
+    EXPECT_TRUE(other.refreshFromJson(e.toJson()));
+    EXPECT_EQ(other.created, e.created);
+    EXPECT_EQ(other.updated, e.updated);
+    EXPECT_EQ(other.started, e.started);
+    EXPECT_EQ(other.s, e.s);
+}
+
+TEST_F(JsonTimestampEncodingOfTest, SpecializedType_RejectsOtherEncodings)
+{
+    Event e;
+    auto json       = e.toJson();
+    json["created"] = SAMPLE_SECONDS.count();
+    EXPECT_FALSE(e.refreshFromJson(json));
+
+    json["created"] = "not a timestamp";
+    EXPECT_FALSE(e.refreshFromJson(json));
+}
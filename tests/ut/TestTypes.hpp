@@ -0,0 +1,93 @@
+#ifndef TESTS_UT_TESTTYPES_HPP_
+#define TESTS_UT_TESTTYPES_HPP_
+
+#include "JsonObjectConverter.hpp"
+
+#include <list>
+#include <optional>
+#include <string>
+
+/**
+ * Representative JsonObject types shared by the unit tests.
+ */
+
+struct TestStruct : public joc::JsonObject
+{
+    TestStruct()
+        : JsonObject({
+            {"a", a},
+            {"b", b},
+            {"c", c},
+        }){};
+    int a{0};
+    std::string b{"default"};
+    std::optional<double> c;
+};
+
+struct TestStructWithList : public joc::JsonObject
+{
+    TestStructWithList()
+        : JsonObject({{"my_list", list}}){};
+
+    std::list<TestStruct> list;
+};
+
+// Same as the types in joc_sample.cpp
+enum ContactType
+{
+    Family,
+    Friend,
+    Work
+};
+
+inline void to_json(nlohmann::json& j, const ContactType& contactType)
+{
+    switch (contactType)
+    {
+    case ContactType::Family:
+        j = "Family";
+        return;
+    case ContactType::Friend:
+        j = "Friend";
+        return;
+    default:
+        j = "Work";
+    }
+}
+
+inline void from_json(const nlohmann::json& j, ContactType& contactType)
+{
+    if (j == "Family")
+    {
+        contactType = ContactType::Family;
+    }
+    else if (j == "Friend")
+    {
+        contactType = ContactType::Friend;
+    }
+    else
+    {
+        contactType = ContactType::Work;
+    }
+}
+
+struct Contact : public joc::JsonObject
+{
+    Contact()
+        : JsonObject({{"type", type}, {"name", name}, {"address", address}, {"age", age}, {"e-mail", email}}){};
+    ContactType type{ContactType::Work};
+    std::string name;
+    std::string address;
+    int age{0};
+    std::optional<std::string> email;
+};
+
+struct ContactBook : public joc::JsonObject
+{
+    ContactBook()
+        : JsonObject({{"owner", owner}, {"contact_list", contactList}}){};
+    std::string owner;
+    std::list<Contact> contactList;
+};
+
+#endif